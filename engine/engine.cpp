@@ -12,9 +12,11 @@
 
 static const double TAU = 2*M_PI;
 
-int main( int argc, char *argv[] )
+/** Walks mojca ten steps east on the maze of e, returns where she ends. */
+template <typename Engine>
+osg::Vec2d
+walk(Engine& e)
 {
-    engine::engine e;
     e.addActor(
             engine::actor(
                 "mojca", //name
@@ -46,8 +48,20 @@ int main( int argc, char *argv[] )
             }
             );
 
+    return e.getActor("mojca").position;
+}
+
+int main( int argc, char *argv[] )
+{
+    engine::engine e;
+    const osg::Vec2d end = walk(e);
+
     // check if everybody is where he/she is supposed to be
-    assert(abs((e.getActor("mojca").position - osg::Vec2d(11,1)).length()) < 0.1);
+    assert(abs((end - osg::Vec2d(11,1)).length()) < 0.1);
+
+    // a Maze of the same seed has the same walls, so she ends up the same
+    engine::basic_engine<maps::Maze> on_maze(maps::Maze(41, 43, 1));
+    assert((walk(on_maze) - end).length() < 1e-9);
 
     return EXIT_SUCCESS;
 }               /* --------  end of function main  ---------- */
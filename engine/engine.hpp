@@ -9,12 +9,14 @@
  * @since 2012-04-24
  */
 
+#include "../maps/fixed_maze.hpp"
 #include "../maps/maze.hpp"
 
 #include <osg/Vec2d>
 #include <string>
 #include <memory>
 #include <map>
+#include <vector>
 
 namespace engine {
 
@@ -121,45 +123,82 @@ struct Attack{
 
 
 
-class engine {
+/**
+ * The simulation, over any maze with the maze interface (see
+ * maps::FixedMaze) - a maps::Maze, or a maps::FixedMaze for the small
+ * fixed arenas, which needs no allocation to set up.
+ */
+template <typename MazeT>
+class basic_engine {
     std::map<std::string, actor> actors;
-    std::shared_ptr<maps::Maze> maze;
+    MazeT maze;
 
     double dt;
     double time;
 
+    // per tick scratch for the batched collision test, kept to reuse memory
+    std::vector<actor*> movers;
+    std::vector<double> next_x;
+    std::vector<double> next_y;
+    std::vector<std::uint64_t> passable;
+
     public:
-    engine()
+    explicit basic_engine(const MazeT& maze)
         : actors()
-        , maze(std::make_shared<maps::Maze>(41, 43, 1))
+        , maze(maze)
         , dt(1./100)
         , time(0)
+        , movers()
+        , next_x()
+        , next_y()
+        , passable()
+    {}
+
+    /** Generates the maze with difficulty 1, for mazes that know their size. */
+    basic_engine()
+        : basic_engine(MazeT(1))
     {}
 
+    const MazeT& getMaze() const { return maze; }
+
     actor& getActor(const std::string& actorId) {
         return actors[actorId];
     }
 
 /*     void maze_interface_demo() {
         size_t i = 0, j = 0;
-        maze->isWall(i, j);
-        maze->isPath(i, j);
-        maze->getStart();  // std::pair<size_t, size_t>
-        maze->getFinish(); // std::pair<size_t, size_t>
+        maze.isWall(i, j);
+        maze.isPath(i, j);
+        maze.getStart();  // std::pair<size_t, size_t>
+        maze.getFinish(); // std::pair<size_t, size_t>
     }
 */
     // moves the simulation forward one tick (0.016 of a second)
     void simulate() {
         time += dt;
-        for (auto name_actor_pair : actors) {
+        // collide everyone against the maze in one go
+        movers.clear();
+        next_x.clear();
+        next_y.clear();
+        for (auto& name_actor_pair : actors) {
             auto& actor = name_actor_pair.second;
             auto endposition =
                 actor.position + actor.getSpeedAsVector()*dt;
-            if (maze->isPath(
-                        endposition.x(), endposition.y()))
-            {
-                actor.position = endposition;
+            movers.push_back(&actor);
+            next_x.push_back(endposition.x());
+            next_y.push_back(endposition.y());
+        }
+        passable.resize((movers.size() + 63) / 64);
+        maze.isPathBatch(next_x.data(), next_y.data(), movers.size(),
+                         passable.data());
+        for (size_t i = 0; i < movers.size(); ++i) {
+            if ((passable[i / 64] >> (i % 64)) & 1) {
+                movers[i]->position = osg::Vec2d(next_x[i], next_y[i]);
             }
+        }
+
+        for (auto& name_actor_pair : actors) {
+            auto& actor = name_actor_pair.second;
             actor.direction += actor.angular_velocity*dt;
             if (actor.attack.is_attack_now(time, dt)) {
                 // attack damage happens now
@@ -230,6 +269,8 @@ class engine {
 
 };
 
+/** The engine of a match, on the standard 41 x 43 arena. */
+typedef basic_engine<maps::FixedMaze<41, 43>> engine;
 
 }/*end namespace*/
 
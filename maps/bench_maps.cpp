@@ -0,0 +1,361 @@
+/**
+ * @file bench_maps.cpp
+ * Benchmarks for the maze generators and queries.
+ *
+ * usage: bench_maps [max_size]
+ *
+ * Prints one JSON object to stdout, so runs on different revisions can be
+ * stored and compared by scripts:
+ * <pre>
+ * { "cores": n,
+ *   "sizes": [ { "width", "height", "generate_serial_s" (null when
+ *                skipped), "generate_tiled_1_s", "generate_tiled_s",
+ *                "populate_s", "blind_ends_s", "blind_ends", "is_path_ns",
+ *                "is_path_batch_ns", "peak_rss_kb" }, ... ],
+ *   "visibility": { "rays", "tick_s", "ray_ns", "fov_s", "fov_cells" },
+ *   "layouts": [ { "layout", "width", "height", "bfs_s", "bfs_cells_per_s",
+ *                  "reached", "classify_s", "classify_cells_per_s" }, ... ],
+ *   "codec": [ { "width", "height", "raw_bytes", "encoded_bytes", "ratio",
+ *                "encode_s", "decode_s" }, ... ] }
+ * </pre>
+ * Every size runs in a child process, so peak_rss_kb is the peak of that
+ * size alone.
+ *
+ * @since 2026-10-17
+ */
+
+#include "bitgrid.hpp"
+#include "maze.hpp"
+#include "maze_codec.hpp"
+#include "neighborhood.hpp"
+#include "visibility.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <sstream>
+#include <thread>
+
+#include <sys/resource.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+namespace {
+
+/** Seconds taken by f(). */
+template <typename F>
+double time_it(F f)
+{
+    auto t0 = std::chrono::steady_clock::now();
+    f();
+    auto t1 = std::chrono::steady_clock::now();
+    return std::chrono::duration<double>(t1 - t0).count();
+}
+
+/** Peak resident set of this process, in kB. */
+long
+peak_rss_kb()
+{
+    struct rusage usage;
+    getrusage(RUSAGE_SELF, &usage);
+    return usage.ru_maxrss;
+}
+
+/** Keeps the optimizer from dropping work whose result is unused. */
+volatile std::uint64_t sink;
+
+const size_t QUERIES = 1 << 20;
+
+/** Measures one size and prints its JSON record. */
+void
+bench_size(size_t width, size_t height, unsigned int cores)
+{
+    using maps::Maze;
+
+    std::cout << "    { \"width\": " << width << ", \"height\": " << height;
+
+    // the serial walks are cubic in the side, skip them when huge
+    std::cout << ", \"generate_serial_s\": ";
+    if (std::max(width, height) <= 401) {
+        std::cout << time_it([&]{ Maze(width, height, 1, 1, 0); });
+    } else {
+        std::cout << "null";
+    }
+    std::cout << ", \"generate_tiled_1_s\": "
+              << time_it([&]{ Maze(width, height, 1, 1, 1); });
+
+    Maze* generated = nullptr;
+    std::cout << ", \"generate_tiled_s\": "
+              << time_it([&]{ generated = new Maze(width, height, 1, 1,
+                                                   cores); });
+    Maze& maze = *generated;
+
+    // blind ends and object placement, on a copy of the walls
+    maps::BitGrid walls = maze.getGrid();
+    std::cout << ", \"populate_s\": "
+              << time_it([&]{ Maze(std::move(walls), 1, 1); });
+
+    size_t blind_ends = 0;
+    std::cout << ", \"blind_ends_s\": "
+              << time_it([&]{
+                     blind_ends =
+                         maps::Neighborhood(maze.getGrid()).blindEnds().size();
+                 })
+              << ", \"blind_ends\": " << blind_ends;
+
+    utility::generator rng(1);
+    std::vector<double> xs(QUERIES), ys(QUERIES);
+    for (size_t i = 0; i < QUERIES; ++i) {
+        xs[i] = rng.bounded(maze.getWidth() * 16) / 16.0;
+        ys[i] = rng.bounded(maze.getHeight() * 16) / 16.0;
+    }
+    std::uint64_t hits = 0;
+    std::cout << ", \"is_path_ns\": "
+              << time_it([&]{
+                     for (size_t i = 0; i < QUERIES; ++i) {
+                         hits += maze.isPath(xs[i], ys[i]);
+                     }
+                 }) * 1e9 / QUERIES;
+    std::vector<std::uint64_t> mask(QUERIES / 64);
+    std::cout << ", \"is_path_batch_ns\": "
+              << time_it([&]{
+                     maze.isPathBatch(xs.data(), ys.data(), QUERIES,
+                                      mask.data());
+                 }) * 1e9 / QUERIES;
+    sink = hits + mask[0];
+
+    std::cout << ", \"peak_rss_kb\": " << peak_rss_kb() << " }";
+    delete generated;
+}
+
+/** A tick's worth of line of sight checks: 10k rays of up to 24 cells. */
+void
+bench_visibility(unsigned int cores)
+{
+    using maps::Maze;
+    using maps::Visibility;
+
+    const size_t RAYS = 10000, TICKS = 100, RANGE = 24;
+    Maze maze(1001, 1001, 1, 1, cores);
+    Visibility visibility(maze);
+
+    utility::generator rng(1);
+    auto random_path = [&](size_t x0, size_t y0, size_t span) {
+        for (;;) {
+            size_t x = x0 + rng.bounded(span), y = y0 + rng.bounded(span);
+            if (x < maze.getWidth() && y < maze.getHeight() &&
+                maze.isPath(x, y)) {
+                return Visibility::cell(x, y);
+            }
+        }
+    };
+    std::vector<Visibility::Ray> rays;
+    for (size_t i = 0; i < RAYS; ++i) {
+        auto from = random_path(0, 0, maze.getWidth());
+        auto to = random_path(from.first  > RANGE ? from.first  - RANGE : 0,
+                              from.second > RANGE ? from.second - RANGE : 0,
+                              2 * RANGE + 1);
+        rays.push_back(Visibility::Ray{ from, to });
+    }
+
+    std::vector<std::uint64_t> mask((RAYS + 63) / 64);
+    double rays_time = time_it([&]{
+        for (size_t t = 0; t < TICKS; ++t) {
+            visibility.canSeeBatch(rays.data(), rays.size(), mask.data());
+        }
+    }) / TICKS;
+
+    std::vector<Visibility::cell> fov;
+    size_t seen = 0;
+    double fov_time = time_it([&]{
+        for (size_t i = 0; i < 1000; ++i) {
+            visibility.fieldOfView(rays[i].from, 12, fov);
+            seen += fov.size();
+        }
+    }) / 1000;
+
+    std::cout << "  \"visibility\": { \"rays\": " << RAYS
+              << ", \"tick_s\": " << rays_time
+              << ", \"ray_ns\": " << rays_time * 1e9 / RAYS
+              << ", \"fov_s\": " << fov_time
+              << ", \"fov_cells\": " << seen / 1000 << " }," << std::endl;
+}
+
+/** Number of cells a flood through the paths of grid reaches from start. */
+template <typename Grid>
+size_t
+flood(const Grid& grid, std::pair<size_t, size_t> start)
+{
+    typedef std::pair<std::uint32_t, std::uint32_t> cell;
+    const size_t w = grid.getWidth(), h = grid.getHeight();
+    Grid seen(w, h); // marked as walls
+    std::vector<cell> frontier(1, cell(start.first, start.second)), next;
+    seen.set(start.first, start.second, true, 0);
+    size_t reached = 1;
+    while (!frontier.empty()) {
+        next.clear();
+        for (auto c : frontier) {
+            const size_t x = c.first, y = c.second;
+            const cell around[4] = { cell(x - 1, y), cell(x + 1, y),
+                                     cell(x, y - 1), cell(x, y + 1) };
+            for (auto n : around) {
+                // unsigned wrap makes -1 fail the bounds test too
+                if (n.first < w && n.second < h &&
+                    !grid.isWall(n.first, n.second) &&
+                    !seen.isWall(n.first, n.second)) {
+                    seen.set(n.first, n.second, true, 0);
+                    next.push_back(n);
+                    ++reached;
+                }
+            }
+        }
+        frontier.swap(next);
+    }
+    return reached;
+}
+
+/** Classifies every cell by its open sides; a checksum of the classes. */
+template <typename Grid>
+size_t
+classify(const Grid& grid)
+{
+    const size_t w = grid.getWidth(), h = grid.getHeight();
+    auto wall = [&](size_t x, size_t y) {
+        return x >= w || y >= h || grid.isWall(x, y);
+    };
+    size_t counts[6] = { 0 };
+    for (size_t y = 0; y < h; ++y) {
+        for (size_t x = 0; x < w; ++x) {
+            if (wall(x, y)) {
+                ++counts[5];
+            } else {
+                ++counts[!wall(x - 1, y) + !wall(x + 1, y) +
+                         !wall(x, y - 1) + !wall(x, y + 1)];
+            }
+        }
+    }
+    size_t sum = 0;
+    for (size_t i = 0; i < 6; ++i) { sum = sum * 31 + counts[i]; }
+    return sum;
+}
+
+template <typename Layout>
+void
+bench_layout(const char* name, const maps::Maze& maze)
+{
+    const maps::BasicBitGrid<Layout> grid(maze.getGrid());
+    const double cells = double(grid.getWidth()) * grid.getHeight();
+
+    size_t reached = 0;
+    const double bfs_time = time_it([&]{
+        reached = flood(grid, maze.getStart());
+    });
+    const double classify_time = time_it([&]{ sink = classify(grid); });
+
+    std::cout << "    { \"layout\": \"" << name << "\""
+              << ", \"width\": " << grid.getWidth()
+              << ", \"height\": " << grid.getHeight()
+              << ", \"bfs_s\": " << bfs_time
+              << ", \"bfs_cells_per_s\": " << reached / bfs_time
+              << ", \"reached\": " << reached
+              << ", \"classify_s\": " << classify_time
+              << ", \"classify_cells_per_s\": " << cells / classify_time
+              << " }";
+}
+
+/** Floods and cell classification on each grid layout, 4k to 16k wide. */
+void
+bench_layouts(size_t max_size, unsigned int cores)
+{
+    std::cout << "  \"layouts\": [" << std::endl;
+    const char* separator = "";
+    for (size_t size = 4097; size <= std::min<size_t>(max_size, 16385);
+         size = size * 2 - 1) {
+        maps::Maze maze(size, size, 1, 1, cores);
+        std::cout << separator;
+        bench_layout<maps::RowMajor>("row_major", maze);
+        std::cout << "," << std::endl;
+        bench_layout<maps::Tiled8x8>("tiled_8x8", maze);
+        std::cout << "," << std::endl;
+        bench_layout<maps::Morton>("morton", maze);
+        separator = ",\n";
+    }
+    std::cout << std::endl << "  ]," << std::endl;
+}
+
+/** Encoded size against the bit grid, and the time to code, 1k to 16k. */
+void
+bench_codec(size_t max_size, unsigned int cores)
+{
+    std::cout << "  \"codec\": [" << std::endl;
+    const char* separator = "";
+    for (size_t size = 1025; size <= std::min<size_t>(max_size, 16385);
+         size = size * 4 - 3) {
+        const maps::Maze maze(size, size, 1, 1, cores);
+        std::stringstream buffer;
+        const double encode_time = time_it([&]{
+            maps::encode_maze(maze, buffer);
+        });
+        const size_t encoded = buffer.str().size();
+        const double decode_time = time_it([&]{
+            sink = maps::decode_maze(buffer, size * size).getWidth();
+        });
+        const size_t raw = maze.getGrid().memoryUsage();
+
+        std::cout << separator
+                  << "    { \"width\": " << size
+                  << ", \"height\": " << size
+                  << ", \"raw_bytes\": " << raw
+                  << ", \"encoded_bytes\": " << encoded
+                  << ", \"ratio\": " << double(raw) / encoded
+                  << ", \"encode_s\": " << encode_time
+                  << ", \"decode_s\": " << decode_time << " }";
+        separator = ",\n";
+    }
+    std::cout << std::endl << "  ]" << std::endl;
+}
+
+} // end anonymous namespace
+
+int main( int argc, char *argv[] )
+{
+    size_t max_size = (argc > 1) ? std::strtoul(argv[1], NULL, 0) : 16385;
+    unsigned int cores = std::max(1u, std::thread::hardware_concurrency());
+
+    std::vector<std::pair<size_t, size_t>> sizes = { { 41, 43 } };
+    for (size_t size = 129; size <= 16385; size = size * 2 - 1) {
+        sizes.push_back(std::make_pair(size, size));
+    }
+
+    std::cout << "{" << std::endl
+              << "  \"cores\": " << cores << "," << std::endl
+              << "  \"sizes\": [" << std::endl;
+    const char* separator = "";
+    for (auto& s : sizes) {
+        if (std::max(s.first, s.second) > max_size) { break; }
+        std::cout << separator;
+        separator = ",\n";
+        std::cout.flush();
+        pid_t child = fork();
+        if (child == 0) {
+            bench_size(s.first, s.second, cores);
+            std::cout.flush();
+            std::_Exit(EXIT_SUCCESS);
+        }
+        int status = 0;
+        if (child < 0 || waitpid(child, &status, 0) < 0 ||
+            !WIFEXITED(status) || WEXITSTATUS(status) != EXIT_SUCCESS) {
+            std::cerr << "bench_maps: size " << s.first << "x" << s.second
+                      << " failed" << std::endl;
+            return EXIT_FAILURE;
+        }
+    }
+    std::cout << std::endl << "  ]," << std::endl;
+    bench_visibility(cores);
+    bench_layouts(max_size, cores);
+    bench_codec(max_size, cores);
+    std::cout << "}" << std::endl;
+
+    return EXIT_SUCCESS;
+}               /* ----------  end of function main  ---------- */
@@ -0,0 +1,244 @@
+#ifndef BITGRID_HPP_GUARD
+#define BITGRID_HPP_GUARD
+/**
+ * @file bitgrid.hpp
+ * Bit-plane storage for maze cells.
+ *
+ * A cell is one bit in the wall plane (1 = wall, 0 = path) plus a few bits
+ * of subtype spread over separate subtype planes. With the default RowMajor
+ * layout rows are packed into 64 bit words, bit i of word k of a row being
+ * the cell at x = 64*k + i, so a whole row (or any 64 consecutive cells of
+ * it) can be tested with shifts and popcounts. The other layouts of
+ * grid_layout.hpp have the same cell accessors but not the row ones.
+ *
+ * @since 2026-10-17
+ */
+
+#include "grid_layout.hpp"
+
+#include <algorithm>
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace maps {
+
+template <typename Layout>
+class BasicBitGrid {
+    public:
+    typedef std::uint64_t word_type;
+    typedef Layout layout_type;
+
+    static const size_t WORD_BITS = 64;
+    /** number of subtype planes - a cell can have 2^SUBTYPE_PLANES subtypes */
+    static const size_t SUBTYPE_PLANES = 2;
+
+    private:
+    size_t width;
+    size_t height;
+    Layout layout;
+
+    /** layout.words() words; padding cells are walls */
+    std::vector<word_type> walls;
+    /** SUBTYPE_PLANES planes of layout.words() words each */
+    std::vector<word_type> subtypes;
+
+    inline size_t
+    index(size_t x, size_t y) const {
+        assert(x < width);
+        assert(y < height);
+        return layout.word(x, y);
+    }
+
+    static inline word_type
+    bit(size_t x, size_t y) { return word_type(1) << Layout::bit(x, y); }
+
+    /** mask of the bits past the width in the last word of a row */
+    inline word_type
+    padding_mask() const {
+        size_t used = width % WORD_BITS;
+        return used ? ~word_type(0) << used : word_type(0);
+    }
+
+    inline size_t
+    words_per_row() const {
+        static_assert(Layout::ROW_WORDS, "needs a layout of row words");
+        return layout.words_per_row;
+    }
+
+    public:
+    BasicBitGrid()
+        : width(0)
+        , height(0)
+        , layout(0, 0)
+        , walls()
+        , subtypes()
+    {}
+
+    /** Makes a grid of path cells with subtype 0. */
+    BasicBitGrid(size_t width, size_t height)
+        : width(width)
+        , height(height)
+        , layout(width, height)
+        , walls(layout.words(), 0)
+        , subtypes(SUBTYPE_PLANES * layout.words(), 0)
+    {
+        const size_t pw = layout.paddedWidth(), ph = layout.paddedHeight();
+        for (size_t y = 0; y < ph; ++y) {
+            for (size_t x = y < height ? width : 0; x < pw; ++x) {
+                walls[layout.word(x, y)] |= bit(x, y);
+            }
+        }
+    }
+
+    /** Copies the cells of a grid with another layout. */
+    template <typename Other>
+    explicit BasicBitGrid(const BasicBitGrid<Other>& other)
+        : BasicBitGrid(other.getWidth(), other.getHeight())
+    {
+        for (size_t y = 0; y < height; ++y) {
+            for (size_t x = 0; x < width; ++x) {
+                set(x, y, other.isWall(x, y), other.getSubtype(x, y));
+            }
+        }
+    }
+
+    size_t getWidth()       const { return width; }
+    size_t getHeight()      const { return height; }
+    size_t getWordsPerRow() const { return words_per_row(); }
+
+    inline bool
+    isWall(size_t x, size_t y) const {
+        return walls[index(x, y)] & bit(x, y);
+    }
+
+    inline unsigned int
+    getSubtype(size_t x, size_t y) const {
+        size_t i = index(x, y);
+        size_t plane = walls.size();
+        unsigned int t = 0;
+        for (size_t p = 0; p < SUBTYPE_PLANES; ++p) {
+            t |= ((subtypes[p * plane + i] & bit(x, y)) ? 1u : 0u) << p;
+        }
+        return t;
+    }
+
+    inline void
+    set(size_t x, size_t y, bool wall, unsigned int subtype) {
+        assert(subtype < (1u << SUBTYPE_PLANES));
+        size_t i = index(x, y);
+        size_t plane = walls.size();
+        word_type b = bit(x, y);
+        walls[i] = wall ? (walls[i] | b) : (walls[i] & ~b);
+        for (size_t p = 0; p < SUBTYPE_PLANES; ++p) {
+            word_type& w = subtypes[p * plane + i];
+            w = (subtype >> p) & 1 ? (w | b) : (w & ~b);
+        }
+    }
+
+    /** The wall words of row y, getWordsPerRow() of them. */
+    inline const word_type*
+    wallRow(size_t y) const {
+        assert(y < height);
+        return &walls[y * words_per_row()];
+    }
+
+    inline word_type*
+    wallRow(size_t y) {
+        assert(y < height);
+        return &walls[y * words_per_row()];
+    }
+
+    /** All the wall words, row y starting at y * getWordsPerRow(). */
+    inline const word_type*
+    wallData() const {
+        static_assert(Layout::ROW_WORDS, "needs a layout of row words");
+        return walls.data();
+    }
+
+    /** The words of subtype plane p for row y. */
+    inline const word_type*
+    subtypeRow(size_t p, size_t y) const {
+        assert(p < SUBTYPE_PLANES);
+        assert(y < height);
+        return &subtypes[p * walls.size() + y * words_per_row()];
+    }
+
+    inline word_type*
+    subtypeRow(size_t p, size_t y) {
+        assert(p < SUBTYPE_PLANES);
+        assert(y < height);
+        return &subtypes[p * walls.size() + y * words_per_row()];
+    }
+
+    /** Copies row src_y of src, which must be as wide, over row y. */
+    void
+    copyRow(size_t y, const BasicBitGrid& src, size_t src_y) {
+        assert(src.width == width);
+        const size_t wpr = words_per_row();
+        std::copy(src.wallRow(src_y), src.wallRow(src_y) + wpr, wallRow(y));
+        for (size_t p = 0; p < SUBTYPE_PLANES; ++p) {
+            const word_type* from = src.subtypeRow(p, src_y);
+            std::copy(from, from + wpr, subtypeRow(p, y));
+        }
+    }
+
+    /**
+     * Wall bits of the 64 cells (x, y) .. (x+63, y); bit i is cell x+i.
+     *
+     * x does not need to be aligned and may be negative - cells outside the
+     * grid (including rows outside of it) read as walls, so neighbor tests
+     * on the borders need no special casing.
+     */
+    inline word_type
+    wallWord(std::ptrdiff_t x, std::ptrdiff_t y) const {
+        if (y < 0 || size_t(y) >= height) { return ~word_type(0); }
+        const word_type* row = &walls[size_t(y) * words_per_row()];
+        std::ptrdiff_t wpr = std::ptrdiff_t(words_per_row());
+        // floor division, so negative x picks the word before the row
+        std::ptrdiff_t k = x >= 0 ? x / std::ptrdiff_t(WORD_BITS)
+                                  : -((-x + std::ptrdiff_t(WORD_BITS) - 1)
+                                      / std::ptrdiff_t(WORD_BITS));
+        size_t shift = size_t(x - k * std::ptrdiff_t(WORD_BITS));
+        word_type lo = (k >= 0 && k < wpr)         ? row[k]     : ~word_type(0);
+        if (shift == 0) { return lo; }
+        word_type hi = (k + 1 >= 0 && k + 1 < wpr) ? row[k + 1] : ~word_type(0);
+        return (lo >> shift) | (hi << (WORD_BITS - shift));
+    }
+
+    /** Path bits of the 64 cells starting at (x, y); see wallWord. */
+    inline word_type
+    pathWord(std::ptrdiff_t x, std::ptrdiff_t y) const {
+        return ~wallWord(x, y);
+    }
+
+    /** Number of wall cells in row y. */
+    inline size_t
+    countWalls(size_t y) const {
+        const word_type* row = wallRow(y);
+        size_t n = 0;
+        for (size_t k = 0; k < words_per_row(); ++k) {
+            n += __builtin_popcountll(row[k]);
+        }
+        return n - __builtin_popcountll(padding_mask());
+    }
+
+    /** Bytes of cell storage, for sizing and statistics. */
+    size_t
+    memoryUsage() const {
+        return (walls.size() + subtypes.size()) * sizeof(word_type);
+    }
+};
+
+template <typename Layout>
+const size_t BasicBitGrid<Layout>::WORD_BITS;
+template <typename Layout>
+const size_t BasicBitGrid<Layout>::SUBTYPE_PLANES;
+
+/** The grid of Maze; the word-parallel queries rely on its row words. */
+typedef BasicBitGrid<RowMajor> BitGrid;
+
+} // end namespace maps
+
+#endif
@@ -0,0 +1,150 @@
+/**
+ * @file chunked_maze.cpp
+ * An unbounded maze generated in chunks around whoever looks at it.
+ *
+ * @since 2026-10-17
+ */
+
+#include "chunked_maze.hpp"
+#include "eller.hpp"
+#include "maze.hpp"
+#include "../misc/utility.hpp"
+
+#include <cassert>
+
+namespace maps {
+
+namespace {
+enum class Edge : std::uint64_t { WEST = 1, NORTH = 2 };
+
+/** A seed for the chunk (or an edge of it) at c. */
+std::uint64_t
+mix(std::uint64_t seed, const ChunkedMaze::chunk_coord& c, std::uint64_t what)
+{
+    std::uint64_t h = seed;
+    h = utility::splitmix64(h) ^ std::uint64_t(c.first);
+    h = utility::splitmix64(h) ^ std::uint64_t(c.second);
+    h = utility::splitmix64(h) ^ what;
+    return utility::splitmix64(h);
+}
+} // end anonymous namespace
+
+ChunkedMaze::ChunkedMaze(std::uint64_t seed, size_t chunk_size,
+                         size_t capacity)
+    : seed(seed)
+    , chunk_size(chunk_size)
+    , capacity(capacity)
+    , chunks()
+    , lru()
+    , last_coord()
+    , last_chunk(nullptr)
+{
+    assert(chunk_size >= 2 && chunk_size % 2 == 0);
+    assert(capacity >= 1);
+}
+
+/**
+ * Generates the chunk at c: a perfect maze on the odd,odd rooms, walls on
+ * the west and north edge with the doors the edge seeds ask for. The east
+ * and south edges belong to the neighbors.
+ */
+void
+ChunkedMaze::generate(const chunk_coord& c, BitGrid& grid) const
+{
+    using utility::rand;
+    const size_t s = chunk_size;
+    const auto inner = static_cast<unsigned int>(WallTypes::INNER);
+
+    EllerGenerator rooms(s + 1, s + 1, mix(seed, c, 0));
+    rooms.generate([&](size_t y, const BitGrid& row) {
+        if (y >= s) { return; }
+        for (size_t x = 0; x < s; ++x) {
+            // the frame is no border here, just an ordinary wall
+            bool frame = x == 0 || y == 0;
+            grid.set(x, y, row.isWall(x, 0),
+                     frame ? inner : row.getSubtype(x, 0));
+        }
+    });
+
+    for (auto edge : { Edge::WEST, Edge::NORTH }) {
+        utility::generator g(mix(seed, c, static_cast<std::uint64_t>(edge)));
+        size_t doors = 1 + rand(g, 0, 2);
+        for (size_t i = 0; i < doors; ++i) {
+            size_t at = 2 * rand(g, 0, s/2) + 1;
+            auto normal = static_cast<unsigned int>(PathTypes::NORMAL);
+            if (edge == Edge::WEST) {
+                grid.set(0, at, false, normal);
+            } else {
+                grid.set(at, 0, false, normal);
+            }
+        }
+    }
+}
+
+ChunkedMaze::Chunk&
+ChunkedMaze::chunk(const chunk_coord& c)
+{
+    if (last_chunk && c == last_coord) { return *last_chunk; }
+
+    auto it = chunks.find(c);
+    if (it == chunks.end()) {
+        Chunk fresh{ BitGrid(chunk_size, chunk_size), 0, lru.end() };
+        generate(c, fresh.grid);
+        it = chunks.insert(std::make_pair(c, std::move(fresh))).first;
+        lru.push_front(c);
+        it->second.lru_pos = lru.begin();
+        last_chunk = nullptr; // evict() may remove the old one
+        evict();
+    } else if (!it->second.pins) {
+        lru.splice(lru.begin(), lru, it->second.lru_pos);
+    }
+
+    last_coord = c;
+    last_chunk = &it->second;
+    return it->second;
+}
+
+/** Drops least recently used chunks until we are within capacity. */
+void
+ChunkedMaze::evict()
+{
+    while (lru.size() > capacity) {
+        auto c = lru.back();
+        lru.pop_back();
+        chunks.erase(c);
+        if (last_chunk && c == last_coord) { last_chunk = nullptr; }
+    }
+}
+
+void
+ChunkedMaze::pin(coord_type x, coord_type y)
+{
+    Chunk& ch = chunk(chunkOf(x, y));
+    if (!ch.pins++) {
+        lru.erase(ch.lru_pos);
+        ch.lru_pos = lru.end();
+    }
+}
+
+void
+ChunkedMaze::unpin(coord_type x, coord_type y)
+{
+    auto c = chunkOf(x, y);
+    auto it = chunks.find(c);
+    assert(it != chunks.end() && it->second.pins);
+    if (!--it->second.pins) {
+        lru.push_front(c);
+        it->second.lru_pos = lru.begin();
+        evict();
+    }
+}
+
+void
+ChunkedMaze::clear()
+{
+    for (auto& c : lru) { chunks.erase(c); }
+    lru.clear();
+    last_chunk = nullptr;
+}
+
+} // end namespace maps
@@ -0,0 +1,127 @@
+#ifndef CHUNKED_MAZE_HPP_GUARD
+#define CHUNKED_MAZE_HPP_GUARD
+/**
+ * @file chunked_maze.hpp
+ * An unbounded maze generated in chunks around whoever looks at it.
+ *
+ * @since 2026-10-17
+ */
+
+#include "bitgrid.hpp"
+#include "../misc/random.hpp"
+
+#include <cstdint>
+#include <list>
+#include <unordered_map>
+#include <utility>
+
+namespace maps {
+
+/**
+ * A maze without borders, generated lazily in square chunks.
+ *
+ * Every chunk is a perfect maze of its own, generated from (seed, chunk
+ * coordinate) alone, so a chunk can be thrown away and regenerated
+ * identically later. A chunk owns its west and north edge; the doors in an
+ * edge are also derived from the seed and the edge coordinate, so both
+ * chunks that share it agree on where they are. Every chunk has a door to
+ * its west and north neighbors, which keeps the whole world connected.
+ *
+ * Chunks live in a least recently used cache of bounded size. Chunks that
+ * actors stand in should be pinned - pinned chunks are never evicted and
+ * don't count towards the capacity.
+ *
+ * Not thread safe: even isWall() may generate and evict chunks.
+ */
+class ChunkedMaze {
+    public:
+    typedef std::int64_t coord_type;
+    typedef std::pair<coord_type, coord_type> chunk_coord;
+
+    private:
+    struct chunk_hash {
+        size_t operator()(const chunk_coord& c) const {
+            std::uint64_t h = std::uint64_t(c.first) * 0x9e3779b97f4a7c15ULL;
+            return size_t(utility::splitmix64(h) ^ std::uint64_t(c.second));
+        }
+    };
+
+    struct Chunk {
+        BitGrid grid;
+        unsigned int pins;
+        /** position in lru; only valid while pins == 0 */
+        std::list<chunk_coord>::iterator lru_pos;
+    };
+
+    std::uint64_t seed;
+    size_t chunk_size;
+    size_t capacity;
+
+    std::unordered_map<chunk_coord, Chunk, chunk_hash> chunks;
+    /** unpinned chunks, most recently used first */
+    std::list<chunk_coord> lru;
+
+    /** the chunk of the last lookup, to skip the hash for runs of queries */
+    chunk_coord last_coord;
+    Chunk* last_chunk;
+
+    Chunk& chunk(const chunk_coord& c);
+    void generate(const chunk_coord& c, BitGrid& grid) const;
+    void evict();
+
+    inline coord_type
+    floor_div(coord_type a) const {
+        coord_type s = coord_type(chunk_size);
+        return a >= 0 ? a / s : -((-a + s - 1) / s);
+    }
+
+    public:
+    /**
+     * @param chunk_size side of a chunk in cells; even, a multiple of 64
+     * keeps chunk rows word aligned
+     * @param capacity how many unpinned chunks to keep generated
+     */
+    ChunkedMaze(std::uint64_t seed = utility::generator::DEFAULT_SEED,
+                size_t chunk_size = 64,
+                size_t capacity = 256);
+
+    // last_chunk points into chunks, so copies would dangle
+    ChunkedMaze(const ChunkedMaze&) = delete;
+    ChunkedMaze& operator=(const ChunkedMaze&) = delete;
+
+    /** The chunk that contains cell (x, y). */
+    inline chunk_coord
+    chunkOf(coord_type x, coord_type y) const {
+        return chunk_coord(floor_div(x), floor_div(y));
+    }
+
+    inline bool
+    isWall(coord_type x, coord_type y) {
+        auto c = chunkOf(x, y);
+        coord_type s = coord_type(chunk_size);
+        return chunk(c).grid.isWall(size_t(x - c.first  * s),
+                                    size_t(y - c.second * s));
+    }
+
+    inline bool
+    isPath(coord_type x, coord_type y) { return !isWall(x, y); }
+
+    /** Keeps the chunk of (x, y) generated until it is unpinned. */
+    void pin(coord_type x, coord_type y);
+    /** Undoes one pin() of the chunk of (x, y). */
+    void unpin(coord_type x, coord_type y);
+
+    /** Throws away all unpinned chunks. */
+    void clear();
+
+    size_t getChunkSize() const { return chunk_size; }
+    size_t getCapacity()  const { return capacity; }
+    std::uint64_t getSeed() const { return seed; }
+
+    /** Number of chunks currently generated, pinned ones included. */
+    size_t loadedChunks() const { return chunks.size(); }
+};
+
+} // end namespace maps
+
+#endif
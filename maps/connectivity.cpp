@@ -0,0 +1,126 @@
+/**
+ * @file connectivity.cpp
+ * Connected regions of the path cells of a maze.
+ *
+ * @since 2026-10-17
+ */
+
+#include "connectivity.hpp"
+#include "disjoint_sets.hpp"
+
+#include <algorithm>
+
+namespace maps {
+
+const Connectivity::region_type Connectivity::NO_REGION;
+
+Connectivity::Connectivity(const Maze& maze)
+    : maze(maze)
+    , width(maze.getWidth())
+    , height(maze.getHeight())
+    , labels(width * height, NO_REGION)
+    , root()
+    , sizes()
+    , regions(0)
+{
+    rebuild();
+}
+
+void
+Connectivity::rebuild()
+{
+    const Maze& m = maze.get();
+    DisjointSets runs;
+
+    // a set per run of path cells, united with the runs above it
+    for (size_t y = 0; y < height; ++y) {
+        region_type* row = &labels[y * width];
+        const region_type* above = y ? row - width : nullptr;
+        for (size_t x = 0; x < width; ) {
+            if (m.isWall(x, y)) { row[x++] = NO_REGION; continue; }
+            const region_type run = runs.add();
+            for (; x < width && m.isPath(x, y); ++x) {
+                row[x] = run;
+                if (above && above[x] != NO_REGION) { runs.unite(run, above[x]); }
+            }
+        }
+    }
+
+    // number the sets densely
+    std::vector<region_type> dense(runs.count(), NO_REGION);
+    root.clear();
+    sizes.clear();
+    for (auto& l : labels) {
+        if (l == NO_REGION) { continue; }
+        region_type& d = dense[runs.find(l)];
+        if (d == NO_REGION) {
+            d = region_type(root.size());
+            root.push_back(d);
+            sizes.push_back(0);
+        }
+        l = d;
+        ++sizes[d];
+    }
+    regions = root.size();
+}
+
+/**
+ * Merging points every label of the smaller regions at the largest one,
+ * which costs a pass over the labels ever made but keeps regionOf() a
+ * single lookup.
+ */
+void
+Connectivity::cellChanged(size_t x, size_t y)
+{
+    const Maze& m = maze.get();
+    region_type& label = labels[y * width + x];
+    if (m.isWall(x, y)) {
+        if (label != NO_REGION) { rebuild(); }
+        return;
+    }
+    if (label != NO_REGION) { return; }
+
+    region_type around[4];
+    size_t n = 0;
+    if (x + 1 < width)  { around[n++] = regionOf(x + 1, y); }
+    if (x > 0)          { around[n++] = regionOf(x - 1, y); }
+    if (y + 1 < height) { around[n++] = regionOf(x, y + 1); }
+    if (y > 0)          { around[n++] = regionOf(x, y - 1); }
+    std::sort(around, around + n);
+    n = std::unique(around, around + n) - around;
+    if (n && around[n - 1] == NO_REGION) { --n; } // NO_REGION sorts last
+
+    if (n == 0) { // a region of its own
+        label = region_type(root.size());
+        root.push_back(label);
+        sizes.push_back(1);
+        ++regions;
+        return;
+    }
+    region_type into = around[0];
+    for (size_t i = 1; i < n; ++i) {
+        if (sizes[around[i]] > sizes[into]) { into = around[i]; }
+    }
+    for (size_t i = 0; i < n; ++i) {
+        if (around[i] == into) { continue; }
+        for (auto& r : root) {
+            if (r == around[i]) { r = into; }
+        }
+        sizes[into] += sizes[around[i]];
+        sizes[around[i]] = 0;
+        --regions;
+    }
+    label = into;
+    ++sizes[into];
+}
+
+bool
+Connectivity::sameRegion(const std::vector<cell>& cells) const
+{
+    for (auto& c : cells) {
+        if (!sameRegion(cells.front(), c)) { return false; }
+    }
+    return true;
+}
+
+} // end namespace maps
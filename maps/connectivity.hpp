@@ -0,0 +1,88 @@
+#ifndef CONNECTIVITY_HPP_GUARD
+#define CONNECTIVITY_HPP_GUARD
+/**
+ * @file connectivity.hpp
+ * Connected regions of the path cells of a maze.
+ *
+ * @since 2026-10-17
+ */
+
+#include "maze.hpp"
+
+#include <cstdint>
+#include <functional>
+#include <utility>
+#include <vector>
+
+namespace maps {
+
+/**
+ * Labels every path cell with the 4-connected region it belongs to, so
+ * reachability is a comparison of two labels - the engine can reject
+ * targets in a sealed off pocket without searching.
+ *
+ * Regions are labeled with one scanline pass: each run of path cells in a
+ * row is united with the runs it touches in the row above, then the sets
+ * are numbered densely.
+ *
+ * Opening a cell merges the regions around it in place. A new wall may cut
+ * a region in two, which can't be told locally, so closing a cell labels
+ * the maze again.
+ */
+class Connectivity {
+    public:
+    typedef std::pair<size_t, size_t> cell;
+    typedef std::uint32_t region_type;
+
+    static const region_type NO_REGION = ~region_type(0);
+
+    private:
+    std::reference_wrapper<const Maze> maze;
+    size_t width;
+    size_t height;
+
+    /** per cell: the region it was labeled with, NO_REGION for walls */
+    std::vector<region_type> labels;
+    /** label -> the region it has been merged into */
+    std::vector<region_type> root;
+    /** cells of each region, by root */
+    std::vector<size_t> sizes;
+    size_t regions;
+
+    public:
+    explicit Connectivity(const Maze& maze);
+
+    /** Labels the whole maze again. */
+    void rebuild();
+
+    /** Brings the labels up to date after cell (x, y) changed. */
+    void cellChanged(size_t x, size_t y);
+
+    /** The region of (x, y), NO_REGION for walls. */
+    inline region_type
+    regionOf(size_t x, size_t y) const {
+        assert(x < width);
+        assert(y < height);
+        region_type l = labels[y * width + x];
+        return l == NO_REGION ? NO_REGION : root[l];
+    }
+
+    /** Whether a path leads from a to b. */
+    inline bool
+    sameRegion(cell a, cell b) const {
+        region_type r = regionOf(a.first, a.second);
+        return r != NO_REGION && r == regionOf(b.first, b.second);
+    }
+
+    /** Whether all of cells are reachable from each other. */
+    bool sameRegion(const std::vector<cell>& cells) const;
+
+    /** Number of path cells in region r. */
+    size_t regionSize(region_type r) const { return sizes[r]; }
+
+    size_t regionCount() const { return regions; }
+};
+
+} // end namespace maps
+
+#endif
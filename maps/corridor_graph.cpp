@@ -0,0 +1,343 @@
+/**
+ * @file corridor_graph.cpp
+ * The maze collapsed into a graph of junctions joined by corridors.
+ *
+ * @since 2026-10-17
+ */
+
+#include "corridor_graph.hpp"
+#include "stamped_set.hpp"
+
+#include <algorithm>
+#include <functional>
+#include <limits>
+#include <queue>
+
+namespace maps {
+
+const CorridorGraph::id_type CorridorGraph::NONE;
+
+namespace {
+const CorridorGraph::id_type UNASSIGNED = CorridorGraph::NONE - 1;
+const std::uint64_t INFINITE = std::numeric_limits<std::uint64_t>::max();
+
+const int DX[4] = { 1, -1, 0,  0 };
+const int DY[4] = { 0,  0, 1, -1 };
+
+/** Dijkstra state of one thread; only reached nodes have a distance. */
+struct Workspace {
+    StampedSet reached;
+    std::vector<std::uint64_t> dist;
+    std::vector<CorridorGraph::id_type> pred_node;
+    std::vector<CorridorGraph::id_type> pred_edge;
+
+    Workspace() : reached(), dist(), pred_node(), pred_edge() {}
+
+    void
+    begin(size_t n)
+    {
+        if (dist.size() != n) {
+            dist.resize(n);
+            pred_node.resize(n);
+            pred_edge.resize(n);
+        }
+        reached.clear(n);
+    }
+
+    inline std::uint64_t
+    get(CorridorGraph::id_type n) const {
+        return reached.contains(n) ? dist[n] : INFINITE;
+    }
+
+    inline void
+    set(CorridorGraph::id_type n, std::uint64_t d,
+        CorridorGraph::id_type via_node, CorridorGraph::id_type via_edge) {
+        reached.insert(n);
+        dist[n] = d;
+        pred_node[n] = via_node;
+        pred_edge[n] = via_edge;
+    }
+};
+
+thread_local Workspace workspace;
+} // end anonymous namespace
+
+CorridorGraph::CorridorGraph(const Maze& maze)
+    : width(maze.getWidth())
+    , height(maze.getHeight())
+    , cell_ids(width * height, NONE)
+    , nodes()
+    , edges()
+    , corridor()
+    , corridor_edge()
+    , adjacency_begin()
+    , adjacency()
+{
+    auto open = [&](long x, long y) {
+        return x >= 0 && y >= 0 && size_t(x) < width && size_t(y) < height &&
+               maze.isPath(x, y);
+    };
+    auto id = [&](size_t x, size_t y) -> id_type& {
+        return cell_ids[y * width + x];
+    };
+
+    /* junctions and dead ends are nodes, the rest are corridor */
+    for (size_t y = 0; y < height; ++y) {
+        for (size_t x = 0; x < width; ++x) {
+            if (!maze.isPath(x, y)) { continue; }
+            int degree = 0;
+            for (int d = 0; d < 4; ++d) { degree += open(x+DX[d], y+DY[d]); }
+            if (degree == 2) {
+                id(x, y) = UNASSIGNED;
+            } else {
+                id(x, y) = id_type(nodes.size()) | NODE_BIT;
+                nodes.push_back(cell(x, y));
+            }
+        }
+    }
+
+    /* follow every corridor out of every node */
+    auto walk = [&](id_type n) {
+        const cell start = nodes[n];
+        for (int d = 0; d < 4; ++d) {
+            long cx = long(start.first) + DX[d], cy = long(start.second) + DY[d];
+            if (!open(cx, cy)) { continue; }
+            id_type c = id(cx, cy);
+            if (c != UNASSIGNED) {
+                // adjacent nodes get a corridor of length 1, made once
+                if (c & NODE_BIT && n < (c & ~NODE_BIT)) {
+                    edges.push_back(Edge{ n, c & ~NODE_BIT, 1,
+                                          std::uint32_t(corridor.size()), 0 });
+                }
+                continue;
+            }
+            const id_type e = id_type(edges.size());
+            const std::uint32_t first = std::uint32_t(corridor.size());
+            long px = start.first, py = start.second;
+            while (id(cx, cy) == UNASSIGNED) {
+                id(cx, cy) = id_type(corridor.size());
+                corridor.push_back(cell(cx, cy));
+                corridor_edge.push_back(e);
+                for (int k = 0; k < 4; ++k) {
+                    long nx = cx + DX[k], ny = cy + DY[k];
+                    if ((nx != px || ny != py) && open(nx, ny)) {
+                        px = cx; py = cy; cx = nx; cy = ny;
+                        break;
+                    }
+                }
+            }
+            std::uint32_t count = std::uint32_t(corridor.size()) - first;
+            edges.push_back(Edge{ n, id(cx, cy) & ~NODE_BIT, count + 1,
+                                  first, count });
+        }
+    };
+    for (id_type n = 0; n < nodes.size(); ++n) { walk(n); }
+
+    /* corridors that are closed loops have no node yet */
+    for (size_t y = 0; y < height; ++y) {
+        for (size_t x = 0; x < width; ++x) {
+            if (id(x, y) == UNASSIGNED) {
+                id_type n = id_type(nodes.size());
+                id(x, y) = n | NODE_BIT;
+                nodes.push_back(cell(x, y));
+                walk(n);
+            }
+        }
+    }
+
+    /* adjacency lists */
+    adjacency_begin.assign(nodes.size() + 1, 0);
+    for (auto& e : edges) {
+        ++adjacency_begin[e.a + 1];
+        if (e.b != e.a) { ++adjacency_begin[e.b + 1]; }
+    }
+    for (size_t n = 0; n < nodes.size(); ++n) {
+        adjacency_begin[n+1] += adjacency_begin[n];
+    }
+    adjacency.resize(adjacency_begin.back());
+    std::vector<std::uint32_t> fill(adjacency_begin.begin(),
+                                    adjacency_begin.end() - 1);
+    for (id_type e = 0; e < edges.size(); ++e) {
+        adjacency[fill[edges[e].a]++] = e;
+        if (edges[e].b != edges[e].a) { adjacency[fill[edges[e].b]++] = e; }
+    }
+}
+
+CorridorGraph::Location
+CorridorGraph::locate(size_t x, size_t y) const
+{
+    id_type c = cell_ids[y * width + x];
+    if (c == NONE) { return Location{ NONE, NONE, 0 }; }
+    if (c & NODE_BIT) { return Location{ c & ~NODE_BIT, NONE, 0 }; }
+    id_type e = corridor_edge[c];
+    return Location{ NONE, e, c - edges[e].first + 1 };
+}
+
+/**
+ * Dijkstra over the nodes. A cell on a corridor starts (or ends) the
+ * search at both ends of its corridor, offset by how far along it lies.
+ * route_nodes and route_edges, if given, receive the nodes and the edges
+ * between them; both stay empty when the best path never leaves a corridor.
+ */
+std::uint64_t
+CorridorGraph::shortest(cell a, cell b,
+                        std::vector<id_type>* route_nodes,
+                        std::vector<id_type>* route_edges) const
+{
+    if (route_nodes) { route_nodes->clear(); }
+    if (route_edges) { route_edges->clear(); }
+    Location from = locate(a.first, a.second);
+    Location to   = locate(b.first, b.second);
+    if ((from.node == NONE && from.edge == NONE) ||
+        (to.node == NONE && to.edge == NONE)) {
+        return INFINITE;
+    }
+
+    std::uint64_t best = INFINITE;
+    if (from.edge != NONE && from.edge == to.edge) {
+        best = from.offset > to.offset ? from.offset - to.offset
+                                       : to.offset - from.offset;
+    }
+
+    Workspace& ws = workspace;
+    ws.begin(nodes.size());
+    typedef std::pair<std::uint64_t, id_type> item;
+    std::priority_queue<item, std::vector<item>, std::greater<item>> open;
+    auto seed = [&](id_type n, std::uint64_t d) {
+        if (d < ws.get(n)) {
+            ws.set(n, d, NONE, NONE);
+            open.push(item(d, n));
+        }
+    };
+    if (from.node != NONE) {
+        seed(from.node, 0);
+    } else {
+        const Edge& e = edges[from.edge];
+        seed(e.a, from.offset);
+        seed(e.b, e.length - from.offset);
+    }
+
+    /* the cost of finishing from node n, INFINITE if n isn't an end */
+    auto finish = [&](id_type n) -> std::uint64_t {
+        if (to.node != NONE) { return n == to.node ? 0 : INFINITE; }
+        const Edge& e = edges[to.edge];
+        std::uint64_t f = INFINITE;
+        if (n == e.a) { f = to.offset; }
+        if (n == e.b) { f = std::min<std::uint64_t>(f, e.length - to.offset); }
+        return f;
+    };
+    id_type last = NONE;
+    while (!open.empty()) {
+        item top = open.top();
+        open.pop();
+        if (top.first != ws.get(top.second)) { continue; }
+        if (top.first >= best) { break; }
+        const id_type n = top.second;
+        std::uint64_t f = finish(n);
+        if (f != INFINITE && top.first + f < best) {
+            best = top.first + f;
+            last = n;
+        }
+        auto range = edgesOf(n);
+        for (const id_type* it = range.first; it != range.second; ++it) {
+            const Edge& e = edges[*it];
+            id_type m = e.a == n ? e.b : e.a;
+            std::uint64_t d = top.first + e.length;
+            if (d < ws.get(m)) {
+                ws.set(m, d, n, *it);
+                open.push(item(d, m));
+            }
+        }
+    }
+
+    if (last != NONE && route_nodes) {
+        for (id_type n = last; n != NONE; n = ws.pred_node[n]) {
+            route_nodes->push_back(n);
+            if (route_edges && ws.pred_edge[n] != NONE) {
+                route_edges->push_back(ws.pred_edge[n]);
+            }
+        }
+        std::reverse(route_nodes->begin(), route_nodes->end());
+        if (route_edges) {
+            std::reverse(route_edges->begin(), route_edges->end());
+        }
+    }
+    return best;
+}
+
+long
+CorridorGraph::distance(cell a, cell b) const
+{
+    std::uint64_t d = shortest(a, b, nullptr, nullptr);
+    return d == INFINITE ? -1 : long(d);
+}
+
+long
+CorridorGraph::route(cell a, cell b, std::vector<id_type>& route_nodes) const
+{
+    std::uint64_t d = shortest(a, b, &route_nodes, nullptr);
+    return d == INFINITE ? -1 : long(d);
+}
+
+bool
+CorridorGraph::path(cell a, cell b, std::vector<cell>& cells) const
+{
+    cells.clear();
+    std::vector<id_type> route_nodes, route_edges;
+    std::uint64_t best = shortest(a, b, &route_nodes, &route_edges);
+    if (best == INFINITE) { return false; }
+
+    /* the cell offset steps from the a end of edge e */
+    auto at = [&](id_type e, std::uint32_t offset) -> cell {
+        const Edge& edge = edges[e];
+        if (offset == 0) { return nodes[edge.a]; }
+        if (offset == edge.length) { return nodes[edge.b]; }
+        return corridor[edge.first + offset - 1];
+    };
+    /* offsets from .. to of edge e, both included */
+    auto run = [&](id_type e, std::uint32_t from, std::uint32_t to) {
+        for (std::uint32_t o = from; o != to; o = from < to ? o + 1 : o - 1) {
+            cells.push_back(at(e, o));
+        }
+        cells.push_back(at(e, to));
+    };
+
+    Location from = locate(a.first, a.second);
+    Location to   = locate(b.first, b.second);
+    if (route_nodes.empty()) { // never left the corridor
+        run(from.edge, from.offset, to.offset);
+        return true;
+    }
+
+    const id_type first = route_nodes.front(), last = route_nodes.back();
+    if (from.node != NONE) {
+        cells.push_back(nodes[from.node]);
+    } else {
+        const Edge& e = edges[from.edge];
+        // which end of the corridor the search left through
+        bool via_a = e.a == first &&
+                     (e.b != first || from.offset <= e.length - from.offset);
+        run(from.edge, from.offset, via_a ? 0 : e.length);
+    }
+    for (size_t i = 0; i < route_edges.size(); ++i) {
+        const Edge& e = edges[route_edges[i]];
+        if (e.a == route_nodes[i]) {
+            run(route_edges[i], 1, e.length);
+        } else {
+            run(route_edges[i], e.length - 1, 0);
+        }
+    }
+    if (to.node == NONE) {
+        const Edge& e = edges[to.edge];
+        bool via_a = e.a == last &&
+                     (e.b != last || to.offset <= e.length - to.offset);
+        if (via_a) {
+            run(to.edge, 1, to.offset);
+        } else {
+            run(to.edge, e.length - 1, to.offset);
+        }
+    }
+    return true;
+}
+
+} // end namespace maps
@@ -0,0 +1,117 @@
+#ifndef CORRIDOR_GRAPH_HPP_GUARD
+#define CORRIDOR_GRAPH_HPP_GUARD
+/**
+ * @file corridor_graph.hpp
+ * The maze collapsed into a graph of junctions joined by corridors.
+ *
+ * @since 2026-10-17
+ */
+
+#include "maze.hpp"
+
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+namespace maps {
+
+/**
+ * Mazes are mostly one cell wide corridors between junctions. This graph
+ * keeps only the path cells that don't have exactly two path neighbors -
+ * junctions and dead ends - as nodes, and every corridor between two of
+ * them as one edge weighted with its length. Searches then step over a
+ * whole corridor at once.
+ *
+ * A corridor that closes on itself without any junction gets one of its
+ * cells promoted to a node, so every path cell is either a node or lies
+ * on exactly one edge.
+ *
+ * The graph is a snapshot; rebuild it after editing the maze. Queries are
+ * safe to run from several threads at once.
+ */
+class CorridorGraph {
+    public:
+    typedef std::pair<size_t, size_t> cell;
+    typedef std::uint32_t id_type;
+
+    static const id_type NONE = ~id_type(0);
+
+    struct Edge {
+        id_type a, b;       // the end nodes
+        std::uint32_t length; // steps from a to b
+        std::uint32_t first;  // the inner cells are corridor[first ..
+        std::uint32_t count;  //     first + count), ordered from a to b
+    };
+
+    /** Where a path cell lies in the graph. */
+    struct Location {
+        id_type node;          // the node, or NONE if on a corridor
+        id_type edge;          // the corridor, or NONE if a node
+        std::uint32_t offset;  // steps from the corridor's a end
+    };
+
+    private:
+    static const id_type NODE_BIT = id_type(1) << 31;
+
+    size_t width;
+    size_t height;
+
+    /** per cell: NONE for walls, node id | NODE_BIT, or a corridor slot */
+    std::vector<id_type> cell_ids;
+    std::vector<cell> nodes;
+    std::vector<Edge> edges;
+    /** inner cells of all the edges, edge by edge */
+    std::vector<cell> corridor;
+    /** corridor slot -> edge */
+    std::vector<id_type> corridor_edge;
+    /** edges of node n are adjacency[adjacency_begin[n] .. [n+1]) */
+    std::vector<std::uint32_t> adjacency_begin;
+    std::vector<id_type> adjacency;
+
+    /** Dijkstra from a to b; fills route with the nodes and edges taken. */
+    std::uint64_t shortest(cell a, cell b,
+                           std::vector<id_type>* route_nodes,
+                           std::vector<id_type>* route_edges) const;
+
+    public:
+    explicit CorridorGraph(const Maze& maze);
+
+    /** Where (x, y) is in the graph; node and edge both NONE for walls. */
+    Location locate(size_t x, size_t y) const;
+
+    /** Length of a shortest path from a to b, or -1 if there is none. */
+    long distance(cell a, cell b) const;
+
+    /**
+     * A shortest path from a to b as the nodes it passes, in order (the
+     * ends themselves are included only when they are nodes).
+     * @return its length, or -1 if there is none
+     */
+    long route(cell a, cell b, std::vector<id_type>& nodes) const;
+
+    /**
+     * A shortest path from a to b expanded back into cells, a and b
+     * included. @return false if there is none
+     */
+    bool path(cell a, cell b, std::vector<cell>& cells) const;
+
+    size_t nodeCount() const { return nodes.size(); }
+    size_t edgeCount() const { return edges.size(); }
+
+    const cell& node(id_type n) const { return nodes[n]; }
+    const Edge& edge(id_type e) const { return edges[e]; }
+    const cell& corridorCell(id_type e, std::uint32_t i) const {
+        return corridor[edges[e].first + i];
+    }
+
+    /** The edges of node n. */
+    std::pair<const id_type*, const id_type*>
+    edgesOf(id_type n) const {
+        return std::make_pair(adjacency.data() + adjacency_begin[n],
+                              adjacency.data() + adjacency_begin[n+1]);
+    }
+};
+
+} // end namespace maps
+
+#endif
@@ -0,0 +1,86 @@
+#ifndef DISJOINT_SETS_HPP_GUARD
+#define DISJOINT_SETS_HPP_GUARD
+/**
+ * @file disjoint_sets.hpp
+ * Union-find over dense integer ids.
+ *
+ * @since 2026-10-17
+ */
+
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+namespace maps {
+
+/**
+ * Disjoint sets with union by size and path halving - both find() and
+ * unite() are effectively O(1).
+ */
+class DisjointSets {
+    public:
+    typedef std::uint32_t id_type;
+
+    private:
+    std::vector<id_type> parent;
+    std::vector<id_type> size;
+
+    public:
+    explicit DisjointSets(size_t n = 0)
+        : parent()
+        , size()
+    {
+        reset(n);
+    }
+
+    /** Makes n singleton sets 0 .. n-1. */
+    void
+    reset(size_t n)
+    {
+        parent.resize(n);
+        size.assign(n, 1);
+        for (size_t i = 0; i < n; ++i) { parent[i] = id_type(i); }
+    }
+
+    /** Adds a new singleton set and returns its id. */
+    id_type
+    add()
+    {
+        parent.push_back(id_type(parent.size()));
+        size.push_back(1);
+        return parent.back();
+    }
+
+    inline id_type
+    find(id_type x)
+    {
+        while (parent[x] != x) {
+            parent[x] = parent[parent[x]];
+            x = parent[x];
+        }
+        return x;
+    }
+
+    /** Joins the sets of a and b. Returns false if they were already one. */
+    inline bool
+    unite(id_type a, id_type b)
+    {
+        a = find(a);
+        b = find(b);
+        if (a == b) { return false; }
+        if (size[a] < size[b]) { std::swap(a, b); }
+        parent[b] = a;
+        size[a] += size[b];
+        return true;
+    }
+
+    inline bool
+    same(id_type a, id_type b) { return find(a) == find(b); }
+
+    size_t count() const { return parent.size(); }
+};
+
+} // end namespace maps
+
+#endif
@@ -0,0 +1,194 @@
+/**
+ * @file distance_field.cpp
+ * Signed distance from every cell to the walls of the maze.
+ *
+ * @since 2026-10-17
+ */
+
+#include "distance_field.hpp"
+
+#include <algorithm>
+#include <cmath>
+
+namespace maps {
+
+namespace {
+const double INF = 1e20;
+
+/**
+ * One dimensional squared distance transform: d[q] = min over p of
+ * (q - p)^2 + f[p], the lower envelope of parabolas rooted at each p.
+ * v and z need room for n and n + 1 entries.
+ */
+void
+transform_1d(const double* f, size_t n, double* d, size_t* v, double* z)
+{
+    size_t k = 0;
+    v[0] = 0;
+    z[0] = -INF;
+    z[1] = +INF;
+    for (size_t q = 1; q < n; ++q) {
+        double s;
+        for (;;) {
+            const double p = double(v[k]), dq = double(q);
+            s = ((f[q] + dq * dq) - (f[v[k]] + p * p)) / (2 * dq - 2 * p);
+            if (s > z[k] || k == 0) { break; }
+            --k;
+        }
+        ++k;
+        v[k] = q;
+        z[k] = s;
+        z[k + 1] = +INF;
+    }
+    k = 0;
+    for (size_t q = 0; q < n; ++q) {
+        while (z[k + 1] < double(q)) { ++k; }
+        const double dq = double(q) - double(v[k]);
+        d[q] = dq * dq + f[v[k]];
+    }
+}
+} // end anonymous namespace
+
+DistanceField::DistanceField(const Maze& maze)
+    : maze(maze)
+    , width(maze.getWidth())
+    , height(maze.getHeight())
+    , field(width * height, 0)
+    , reach(0)
+{
+    rebuild();
+}
+
+DistanceField::value_type
+DistanceField::transform(size_t x0, size_t y0, size_t x1, size_t y1,
+                         std::vector<value_type>& out) const
+{
+    const Maze& m = maze.get();
+    const size_t w = x1 - x0, h = y1 - y0, n = std::max(w, h);
+    std::vector<double> to_wall(w * h), to_path(w * h);
+    std::vector<double> f(n), d(n), z(n + 1);
+    std::vector<size_t> v(n);
+
+    // columns, then rows over the column results
+    for (int pass = 0; pass < 2; ++pass) {
+        std::vector<double>& g = pass ? to_path : to_wall;
+        const bool feature = !pass; // the walls first, then the paths
+        for (size_t x = 0; x < w; ++x) {
+            for (size_t y = 0; y < h; ++y) {
+                f[y] = m.isWall(x0 + x, y0 + y) == feature ? 0 : INF;
+            }
+            transform_1d(f.data(), h, d.data(), v.data(), z.data());
+            for (size_t y = 0; y < h; ++y) { g[y * w + x] = d[y]; }
+        }
+        for (size_t y = 0; y < h; ++y) {
+            transform_1d(&g[y * w], w, d.data(), v.data(), z.data());
+            std::copy(d.begin(), d.begin() + w, g.begin() + y * w);
+        }
+    }
+
+    out.resize(w * h);
+    value_type top = 0;
+    for (size_t y = 0; y < h; ++y) {
+        for (size_t x = 0; x < w; ++x) {
+            const size_t i = y * w + x;
+            const bool wall = m.isWall(x0 + x, y0 + y);
+            const value_type raw =
+                value_type(std::sqrt(wall ? to_path[i] : to_wall[i]));
+            out[i] = wall ? -(raw - 0.5f) : raw - 0.5f;
+            top = std::max(top, raw);
+        }
+    }
+    return top;
+}
+
+void
+DistanceField::rebuild()
+{
+    reach = transform(0, 0, width, height, field);
+}
+
+/**
+ * A change at c can only alter the cells that are nearer to c than to
+ * their old nearest feature, so those within reach of c. They are
+ * recomputed over a window around them; a cell's value is exact if it is
+ * nearer than the window's edge, otherwise the window grows.
+ */
+void
+DistanceField::cellChanged(size_t x, size_t y)
+{
+    const size_t r = size_t(std::ceil(reach)) + 1;
+    const size_t ix0 = x > r ? x - r : 0, ix1 = std::min(width,  x + r + 1);
+    const size_t iy0 = y > r ? y - r : 0, iy1 = std::min(height, y + r + 1);
+    std::vector<value_type> window;
+
+    for (size_t margin = r + 1; ; margin *= 2) {
+        const size_t wx0 = ix0 > margin ? ix0 - margin : 0;
+        const size_t wy0 = iy0 > margin ? iy0 - margin : 0;
+        const size_t wx1 = std::min(width,  ix1 + margin);
+        const size_t wy1 = std::min(height, iy1 + margin);
+        const size_t w = wx1 - wx0;
+        transform(wx0, wy0, wx1, wy1, window);
+
+        const bool whole = wx0 == 0 && wy0 == 0 &&
+                           wx1 == width && wy1 == height;
+        bool exact = true;
+        for (size_t cy = iy0; cy < iy1 && exact && !whole; ++cy) {
+            for (size_t cx = ix0; cx < ix1; ++cx) {
+                // distance to the nearest cell left out of the window
+                double edge = INF;
+                if (wx0 > 0)      { edge = std::min<double>(edge, cx - wx0 + 1); }
+                if (wy0 > 0)      { edge = std::min<double>(edge, cy - wy0 + 1); }
+                if (wx1 < width)  { edge = std::min<double>(edge, wx1 - cx); }
+                if (wy1 < height) { edge = std::min<double>(edge, wy1 - cy); }
+                value_type v = window[(cy - wy0) * w + (cx - wx0)];
+                if (std::fabs(v) + 0.5 >= edge) { exact = false; break; }
+            }
+        }
+        if (!exact) { continue; }
+
+        for (size_t cy = iy0; cy < iy1; ++cy) {
+            for (size_t cx = ix0; cx < ix1; ++cx) {
+                value_type v = window[(cy - wy0) * w + (cx - wx0)];
+                field[cy * width + cx] = v;
+                reach = std::max(reach, std::fabs(v) + 0.5f);
+            }
+        }
+        return;
+    }
+}
+
+double
+DistanceField::sample(double x, double y) const
+{
+    // cell centers are at +0.5; clamp to the outermost ones
+    const double u = std::min(std::max(x - 0.5, 0.0), double(width  - 1));
+    const double v = std::min(std::max(y - 0.5, 0.0), double(height - 1));
+    const size_t x0 = size_t(u), y0 = size_t(v);
+    const size_t x1 = std::min(x0 + 1, width - 1);
+    const size_t y1 = std::min(y0 + 1, height - 1);
+    const double fx = u - double(x0), fy = v - double(y0);
+
+    const double top    = distance(x0, y0) * (1 - fx) + distance(x1, y0) * fx;
+    const double bottom = distance(x0, y1) * (1 - fx) + distance(x1, y1) * fx;
+    return top * (1 - fy) + bottom * fy;
+}
+
+DistanceField::vector_type
+DistanceField::gradient(double x, double y) const
+{
+    const double u = std::min(std::max(x - 0.5, 0.0), double(width  - 1));
+    const double v = std::min(std::max(y - 0.5, 0.0), double(height - 1));
+    const size_t x0 = size_t(u), y0 = size_t(v);
+    const size_t x1 = std::min(x0 + 1, width - 1);
+    const size_t y1 = std::min(y0 + 1, height - 1);
+    const double fx = u - double(x0), fy = v - double(y0);
+
+    const double d00 = distance(x0, y0), d10 = distance(x1, y0);
+    const double d01 = distance(x0, y1), d11 = distance(x1, y1);
+    // the derivatives of sample(), zero along a clamped axis
+    const double gx = x1 == x0 ? 0 : (d10 - d00) * (1 - fy) + (d11 - d01) * fy;
+    const double gy = y1 == y0 ? 0 : (d01 - d00) * (1 - fx) + (d11 - d10) * fx;
+    return vector_type(gx, gy);
+}
+
+} // end namespace maps
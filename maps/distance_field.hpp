@@ -0,0 +1,94 @@
+#ifndef DISTANCE_FIELD_HPP_GUARD
+#define DISTANCE_FIELD_HPP_GUARD
+/**
+ * @file distance_field.hpp
+ * Signed distance from every cell to the walls of the maze.
+ *
+ * @since 2026-10-17
+ */
+
+#include "maze.hpp"
+
+#include <functional>
+#include <utility>
+#include <vector>
+
+namespace maps {
+
+/**
+ * Euclidean signed distance field of the walls, for collision of actors
+ * with a radius and for steering them away from walls.
+ *
+ * Cell (x, y) covers [x, x+1) x [y, y+1) in maze units, like isPath()
+ * truncating coordinates. The value stored for a path cell is the distance
+ * from its center to the edge of the nearest wall cell - the distance to
+ * that wall's center less half a cell - and for a wall cell the same to the
+ * nearest path cell, negated. Sampling between cell centers interpolates
+ * bilinearly, so the field is 0 on the wall surfaces and a circle of radius
+ * r centered at p is clear of the walls where sample(p) > r.
+ *
+ * Built with the separable linear time transform of Felzenszwalb and
+ * Huttenlocher, one pass over the columns and one over the rows. After
+ * changing a cell call cellChanged(), which recomputes only the window the
+ * change can reach.
+ */
+class DistanceField {
+    public:
+    typedef float value_type;
+    typedef std::pair<double, double> vector_type;
+
+    private:
+    std::reference_wrapper<const Maze> maze;
+    size_t width;
+    size_t height;
+    std::vector<value_type> field;
+    /** bound on the unsigned distance of every cell, to size updates */
+    value_type reach;
+
+    /**
+     * Computes the field over the cells [x0, x1) x [y0, y1) as if nothing
+     * existed outside of them, into out (row-major, window sized).
+     * @return the largest unsigned distance in it
+     */
+    value_type transform(size_t x0, size_t y0, size_t x1, size_t y1,
+                         std::vector<value_type>& out) const;
+
+    public:
+    explicit DistanceField(const Maze& maze);
+
+    /** Recomputes the whole field. */
+    void rebuild();
+
+    /** Brings the field up to date after cell (x, y) changed. */
+    void cellChanged(size_t x, size_t y);
+
+    /** The signed value of cell (x, y). */
+    inline value_type
+    distance(size_t x, size_t y) const {
+        assert(x < width);
+        assert(y < height);
+        return field[y * width + x];
+    }
+
+    /** The field at (x, y) in maze units, bilinear between cell centers. */
+    double sample(double x, double y) const;
+
+    /**
+     * Gradient of sample() at (x, y): points away from the nearest walls
+     * with a length of about 1 near them.
+     */
+    vector_type gradient(double x, double y) const;
+
+    /** Whether a circle of the given radius at (x, y) misses every wall. */
+    inline bool
+    isClear(double x, double y, double radius) const {
+        return sample(x, y) > radius;
+    }
+
+    size_t getWidth()  const { return width; }
+    size_t getHeight() const { return height; }
+};
+
+} // end namespace maps
+
+#endif
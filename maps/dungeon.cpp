@@ -0,0 +1,321 @@
+/**
+ * @file dungeon.cpp
+ * Mazes stacked into floors, joined by stairs and teleports.
+ *
+ * @since 2026-10-17
+ */
+
+#include "dungeon.hpp"
+#include "connectivity.hpp"
+#include "pathfinder.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <deque>
+#include <functional>
+#include <map>
+#include <queue>
+#include <set>
+
+namespace maps {
+
+namespace {
+/** how many floors down a teleport may go */
+const size_t TELEPORT_REACH = 3;
+
+/** A seed for floor i, or for something on it. */
+std::uint64_t
+mix(std::uint64_t seed, size_t i, std::uint64_t what)
+{
+    std::uint64_t h = seed;
+    h = utility::splitmix64(h) ^ std::uint64_t(i);
+    h = utility::splitmix64(h) ^ what;
+    return utility::splitmix64(h);
+}
+} // end anonymous namespace
+
+/** A generated floor, with what the queries need of it. */
+struct Dungeon::Level {
+    Maze maze;
+    Connectivity regions;
+    mutable Pathfinder paths;
+
+    explicit Level(Maze maze)
+        : maze(std::move(maze))
+        , regions(this->maze)
+        , paths(this->maze)
+    {}
+
+    inline Connectivity::region_type
+    regionOf(const cell& c) const {
+        return regions.regionOf(c.first, c.second);
+    }
+};
+
+Dungeon::Dungeon(size_t width, size_t height, size_t levels,
+                 double difficulty, std::uint64_t seed, unsigned int threads,
+                 size_t lookahead, size_t teleports)
+    : width( (width/2)  * 2 + 1) // as Maze rounds them
+    , height((height/2) * 2 + 1)
+    , difficulty(difficulty)
+    , seed(seed)
+    , threads(threads)
+    , lookahead(lookahead)
+    , teleports(levels)
+    , mutex()
+    , levels(levels)
+{
+    const size_t rooms_x = this->width / 2, rooms_y = this->height / 2;
+    for (size_t i = 0; i + 1 < levels; ++i) {
+        for (size_t k = 0; k < teleports; ++k) {
+            utility::generator g(mix(seed, i, k + 1));
+            const size_t j = i + 1 + g.bounded(
+                std::min(TELEPORT_REACH, levels - 1 - i));
+            const Place a = { i, cell(2 * g.bounded(rooms_x) + 1,
+                                      2 * g.bounded(rooms_y) + 1) };
+            const Place b = { j, cell(2 * g.bounded(rooms_x) + 1,
+                                      2 * g.bounded(rooms_y) + 1) };
+            this->teleports[i].push_back(
+                Connector{ ConnectorType::TELEPORT, a, b });
+            this->teleports[j].push_back(
+                Connector{ ConnectorType::TELEPORT, b, a });
+        }
+    }
+
+    std::lock_guard<std::mutex> lock(mutex);
+    for (size_t i = 0; i <= lookahead && i < levels; ++i) { start(i); }
+}
+
+Dungeon::~Dungeon()
+{
+    // the generations still running use this
+    for (auto& level : levels) {
+        if (level.valid()) { level.wait(); }
+    }
+}
+
+Dungeon::level_ptr
+Dungeon::make(size_t i) const
+{
+    return std::make_shared<Level>(Maze(width, height,
+                                        difficulty * (1 + i / 10.0),
+                                        mix(seed, i, 0), threads));
+}
+
+void
+Dungeon::start(size_t i) const
+{
+    if (!levels[i].valid()) {
+        levels[i] = std::async(std::launch::async,
+                               &Dungeon::make, this, i).share();
+    }
+}
+
+const Dungeon::Level&
+Dungeon::get(size_t i) const
+{
+    assert(i < levels.size());
+    std::shared_future<level_ptr> level;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        for (size_t j = i; j <= i + lookahead && j < levels.size(); ++j) {
+            start(j);
+        }
+        level = levels[i];
+    }
+    // the Level is owned by levels[i] as well, so it outlives the future
+    return *level.get();
+}
+
+const Maze&
+Dungeon::level(size_t i) const
+{
+    return get(i).maze;
+}
+
+void
+Dungeon::prefetch(size_t first, size_t last) const
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    for (size_t i = first; i < last && i < levels.size(); ++i) { start(i); }
+}
+
+bool
+Dungeon::isReady(size_t i) const
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    return levels[i].valid() &&
+           levels[i].wait_for(std::chrono::seconds(0)) ==
+               std::future_status::ready;
+}
+
+std::vector<Connector>
+Dungeon::connectors(size_t i) const
+{
+    std::vector<Connector> result;
+    const Maze& here = level(i);
+    if (i > 0) {
+        const Place up = { i - 1, level(i - 1).getFinish() };
+        result.push_back(Connector{ ConnectorType::STAIRS,
+                                    Place{ i, here.getStart() }, up });
+    }
+    if (i + 1 < levels.size()) {
+        const Place down = { i + 1, level(i + 1).getStart() };
+        result.push_back(Connector{ ConnectorType::STAIRS,
+                                    Place{ i, here.getFinish() }, down });
+    }
+    result.insert(result.end(), teleports[i].begin(), teleports[i].end());
+    return result;
+}
+
+bool
+Dungeon::reachable(const Place& a, const Place& b) const
+{
+    typedef std::pair<size_t, Connectivity::region_type> node;
+    const node from(a.level, get(a.level).regionOf(a.position));
+    const node to(b.level, get(b.level).regionOf(b.position));
+    if (from.second == Connectivity::NO_REGION ||
+        to.second == Connectivity::NO_REGION) {
+        return false;
+    }
+
+    // breadth first over the regions of the floors, through the connectors
+    std::map<size_t, std::vector<Connector>> floors;
+    std::set<node> seen{ from };
+    std::deque<node> frontier{ from };
+    while (!frontier.empty()) {
+        const node n = frontier.front();
+        frontier.pop_front();
+        if (n == to) { return true; }
+
+        auto it = floors.find(n.first);
+        if (it == floors.end()) {
+            it = floors.insert(std::make_pair(n.first,
+                                              connectors(n.first))).first;
+        }
+        const Level& here = get(n.first);
+        for (auto& c : it->second) {
+            if (here.regionOf(c.from.position) != n.second) { continue; }
+            const node next(c.to.level,
+                            get(c.to.level).regionOf(c.to.position));
+            if (next.second != Connectivity::NO_REGION &&
+                seen.insert(next).second) {
+                frontier.push_back(next);
+            }
+        }
+    }
+    return false;
+}
+
+bool
+Dungeon::findPath(const Place& from, const Place& to,
+                  std::vector<Place>& path) const
+{
+    path.clear();
+    if (get(from.level).regionOf(from.position) == Connectivity::NO_REGION ||
+        get(to.level).regionOf(to.position) == Connectivity::NO_REGION) {
+        return false;
+    }
+
+    // Dijkstra over from, to and the connector ends, with the steps between
+    // two places on a floor from its Pathfinder
+    typedef std::pair<size_t, cell> key;
+    std::map<key, size_t> ids;
+    std::vector<Place> places;
+    std::vector<long> dist;
+    std::vector<size_t> parent;
+    auto id = [&](const Place& p) {
+        auto it = ids.insert(std::make_pair(key(p.level, p.position),
+                                            places.size())).first;
+        if (it->second == places.size()) {
+            places.push_back(p);
+            dist.push_back(-1);
+            parent.push_back(places.size() - 1);
+        }
+        return it->second;
+    };
+
+    typedef std::pair<long, size_t> entry;
+    std::priority_queue<entry, std::vector<entry>,
+                        std::greater<entry>> open;
+    auto relax = [&](size_t via, const Place& p, long d) {
+        const size_t n = id(p);
+        if (dist[n] < 0 || d < dist[n]) {
+            dist[n] = d;
+            parent[n] = via;
+            open.push(entry(d, n));
+        }
+    };
+
+    const size_t target = id(to);
+    relax(id(from), from, 0);
+    std::map<size_t, std::vector<Connector>> floors;
+    while (!open.empty()) {
+        const entry e = open.top();
+        open.pop();
+        const size_t n = e.second;
+        if (e.first > dist[n]) { continue; } // stale
+        if (n == target) { break; }
+
+        const Place here = places[n];
+        const Level& level = get(here.level);
+        const auto region = level.regionOf(here.position);
+        auto walk = [&](const Place& p) {
+            if (level.regionOf(p.position) == region) {
+                relax(n, p, e.first + level.paths.distance(here.position,
+                                                           p.position));
+            }
+        };
+
+        if (to.level == here.level) { walk(to); }
+        auto it = floors.find(here.level);
+        if (it == floors.end()) {
+            it = floors.insert(std::make_pair(here.level,
+                                              connectors(here.level))).first;
+        }
+        for (auto& c : it->second) {
+            if (c.from == here) {
+                relax(n, c.to, e.first + 1);
+            } else {
+                walk(c.from);
+            }
+        }
+    }
+    if (dist[target] < 0) { return false; }
+
+    std::vector<Place> waypoints(1, places[target]);
+    for (size_t n = target; n != parent[n]; n = parent[n]) {
+        waypoints.push_back(places[parent[n]]);
+    }
+    std::reverse(waypoints.begin(), waypoints.end());
+
+    path.push_back(waypoints.front());
+    Pathfinder::path_type leg;
+    for (size_t i = 1; i < waypoints.size(); ++i) {
+        const Place& a = waypoints[i - 1];
+        const Place& b = waypoints[i];
+        if (a.level != b.level) {
+            path.push_back(b);
+            continue;
+        }
+        get(a.level).paths.findPath(a.position, b.position, leg);
+        for (size_t k = 1; k < leg.size(); ++k) {
+            path.push_back(Place{ a.level, leg[k] });
+        }
+    }
+    return true;
+}
+
+Place
+Dungeon::getStart() const
+{
+    return Place{ 0, level(0).getStart() };
+}
+
+Place
+Dungeon::getFinish() const
+{
+    return Place{ levels.size() - 1, level(levels.size() - 1).getFinish() };
+}
+
+} // end namespace maps
@@ -0,0 +1,149 @@
+#ifndef DUNGEON_HPP_GUARD
+#define DUNGEON_HPP_GUARD
+/**
+ * @file dungeon.hpp
+ * Mazes stacked into floors, joined by stairs and teleports.
+ *
+ * @since 2026-10-17
+ */
+
+#include "maze.hpp"
+
+#include <cstdint>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <utility>
+#include <vector>
+
+namespace maps {
+
+enum class ConnectorType : unsigned int {
+    STAIRS,
+    TELEPORT
+};
+
+/** A cell on a floor of a Dungeon. */
+struct Place {
+    size_t level;
+    std::pair<size_t, size_t> position;
+
+    bool
+    operator==(const Place& o) const {
+        return level == o.level && position == o.position;
+    }
+    bool operator!=(const Place& o) const { return !(*this == o); }
+};
+
+/** A way between two floors, usable both ways. */
+struct Connector {
+    ConnectorType type;
+    Place from;
+    Place to;
+};
+
+/**
+ * A dungeon of levels floors, each a Maze of the same size.
+ *
+ * Floor i's finish is a stairway down to floor i+1's start, so the whole
+ * dungeon can be walked from the start of floor 0 to the finish of the
+ * last. Every floor also has teleports down to one of the next few floors,
+ * between rooms (cells with both coordinates odd, which are never walls).
+ * Where they are follows from the seed alone, so they are known before
+ * the floors they join are.
+ *
+ * The floors are generated on demand, each on a thread of its own: asking
+ * for a floor starts it and the lookahead floors below it, and waits for it
+ * alone, so a match can start as soon as the first floor is there. The
+ * constructor starts floor 0 and its lookahead in the background.
+ *
+ * Reachability and paths across floors go through the connectors; a query
+ * generates the floors it gets to. All methods are safe to call from
+ * several threads at once.
+ */
+class Dungeon {
+    public:
+    typedef std::pair<size_t, size_t> cell;
+
+    private:
+    struct Level;
+    typedef std::shared_ptr<Level> level_ptr;
+
+    size_t width;
+    size_t height;
+    double difficulty;
+    std::uint64_t seed;
+    unsigned int threads;
+    size_t lookahead;
+
+    /** teleports by floor, each stored from both ends */
+    std::vector<std::vector<Connector>> teleports;
+
+    mutable std::mutex mutex;
+    /** the floors, invalid until started */
+    mutable std::vector<std::shared_future<level_ptr>> levels;
+
+    /** starts generating floor i unless it is; needs mutex held */
+    void start(size_t i) const;
+    /** floor i, waiting for it */
+    const Level& get(size_t i) const;
+    level_ptr make(size_t i) const;
+
+    public:
+    /**
+     * @param difficulty of floor 0; floor i is 1 + i / 10 times harder
+     * @param threads each floor is generated with, see Maze
+     * @param lookahead floors below a wanted one generated along with it
+     * @param teleports on every floor but the last
+     */
+    Dungeon(size_t width, size_t height, size_t levels, double difficulty,
+            std::uint64_t seed = utility::generator::DEFAULT_SEED,
+            unsigned int threads = 0, size_t lookahead = 2,
+            size_t teleports = 1);
+
+    /** Waits for the floors still being generated. */
+    ~Dungeon();
+
+    /** Floor i, generating it first if need be. */
+    const Maze& level(size_t i) const;
+
+    /** Starts generating the floors first .. last-1 in the background. */
+    void prefetch(size_t first, size_t last) const;
+
+    /** Whether floor i is generated, without waiting for it. */
+    bool isReady(size_t i) const;
+
+    /**
+     * The connectors with an end on floor i, each turned so that its from
+     * is on floor i. The stairs need the floors next to i.
+     */
+    std::vector<Connector> connectors(size_t i) const;
+
+    /** Whether a path leads from a to b, over as many floors as it takes. */
+    bool reachable(const Place& a, const Place& b) const;
+
+    /**
+     * Finds a shortest path from from to to; taking a connector counts as
+     * one step.
+     *
+     * @param path receives every cell of the path, from and to included,
+     * so a change of floor is two places after each other on different
+     * floors; cleared when there is no path
+     * @return false if to can't be reached from from
+     */
+    bool findPath(const Place& from, const Place& to,
+                  std::vector<Place>& path) const;
+
+    /** The start of floor 0 and the finish of the last floor. */
+    Place getStart() const;
+    Place getFinish() const;
+
+    size_t getLevels() const { return levels.size(); }
+    size_t getWidth() const { return width; }
+    size_t getHeight() const { return height; }
+    std::uint64_t getSeed() const { return seed; }
+};
+
+} // end namespace maps
+
+#endif
@@ -0,0 +1,298 @@
+/**
+ * @file eller.cpp
+ * Streaming, row by row maze generation.
+ *
+ * @since 2026-10-17
+ */
+
+#include "eller.hpp"
+#include "disjoint_sets.hpp"
+#include "exceptions.hpp"
+#include "maze.hpp"
+
+#include <algorithm>
+#include <istream>
+#include <ostream>
+#include <type_traits>
+#include <vector>
+
+namespace maps {
+
+namespace {
+const char ROW_MAGIC[4] = {'H', 'X', 'R', 'W'};
+const std::uint32_t NO_SET = ~std::uint32_t(0);
+
+inline unsigned int
+subtype(WallTypes t) { return static_cast<unsigned int>(t); }
+
+inline unsigned int
+subtype(PathTypes t) { return static_cast<unsigned int>(t); }
+
+/** Makes the whole row a border wall. */
+void
+border_row(BitGrid& row)
+{
+    for (size_t x = 0; x < row.getWidth(); ++x) {
+        row.set(x, 0, true, subtype(WallTypes::BORDER));
+    }
+}
+
+/** Fills the row and puts the border walls on its ends. */
+void
+clear_row(BitGrid& row, bool wall)
+{
+    unsigned int t = wall ? subtype(WallTypes::INNER)
+                          : subtype(PathTypes::NORMAL);
+    for (size_t x = 1; x + 1 < row.getWidth(); ++x) {
+        row.set(x, 0, wall, t);
+    }
+    row.set(0,                  0, true, subtype(WallTypes::BORDER));
+    row.set(row.getWidth() - 1, 0, true, subtype(WallTypes::BORDER));
+}
+
+size_t
+row_words(size_t width)
+{
+    return (width / BitGrid::WORD_BITS + (width % BitGrid::WORD_BITS != 0)) *
+           (1 + BitGrid::SUBTYPE_PLANES);
+}
+
+/**
+ * Reads and checks the header. For a seekable stream the rows it promises
+ * are checked against the bytes left, by dividing the room in the file,
+ * never by multiplying what the header says.
+ *
+ * @return whether the stream was seekable and so the size is checked
+ */
+bool
+read_header(std::istream& in, size_t& width, size_t& height)
+{
+    char magic[4];
+    std::uint64_t dims[2];
+    in.read(magic, sizeof(magic));
+    in.read(reinterpret_cast<char*>(dims), sizeof(dims));
+    if (!in) {
+        throw err::io_error() << err::reason("truncated row file header");
+    }
+    if (!std::equal(magic, magic + 4, ROW_MAGIC)) {
+        throw err::bad_format() << err::reason("not a row file");
+    }
+    const size_t max_words = ~size_t(0) / sizeof(BitGrid::word_type);
+    if (dims[0] == 0 || dims[1] == 0 ||
+        dims[0] / BitGrid::WORD_BITS >=
+            max_words / (1 + BitGrid::SUBTYPE_PLANES) ||
+        dims[1] > max_words / row_words(dims[0])) {
+        throw err::bad_format() << err::reason("bad row file dimensions");
+    }
+    width  = dims[0];
+    height = dims[1];
+
+    const std::streampos here = in.tellg();
+    if (here == std::streampos(-1) || !in.seekg(0, std::ios_base::end)) {
+        in.clear();
+        return false;
+    }
+    const std::uint64_t left = std::uint64_t(in.tellg() - here) /
+                               sizeof(BitGrid::word_type);
+    in.seekg(here);
+    if (height > left / row_words(width)) {
+        throw err::bad_format() << err::reason("row file is truncated");
+    }
+    return true;
+}
+
+/** Reads one row into row y of g, which must be as wide as the file. */
+void
+read_row(std::istream& in, BitGrid& g, size_t y)
+{
+    const std::streamsize bytes =
+        g.getWordsPerRow() * sizeof(BitGrid::word_type);
+    in.read(reinterpret_cast<char*>(g.wallRow(y)), bytes);
+    for (size_t p = 0; p < BitGrid::SUBTYPE_PLANES; ++p) {
+        in.read(reinterpret_cast<char*>(g.subtypeRow(p, y)), bytes);
+    }
+    if (!in) {
+        throw err::io_error() << err::reason("truncated row file");
+    }
+}
+} // end anonymous namespace
+
+void
+EllerGenerator::generate(const row_sink& sink) const
+{
+    utility::generator rng(seed);
+    BitGrid row(width, 1);
+
+    const size_t rooms = (width - 1) / 2;
+    const size_t rows  = (height - 1) / 2;
+
+    border_row(row);
+    sink(0, row);
+    if (!rooms || !rows) {
+        for (size_t y = 1; y < height; ++y) { sink(y, row); }
+        return;
+    }
+
+    // set[c] is the set of the room in column c of the current row; sets
+    // are renumbered after every row so they always stay below rooms.
+    std::vector<std::uint32_t> set(rooms);
+    for (size_t c = 0; c < rooms; ++c) { set[c] = std::uint32_t(c); }
+    DisjointSets sets(rooms);
+    std::vector<char> down(rooms);
+    std::vector<std::uint32_t> downs(rooms), last(rooms), renumber(rooms);
+
+    for (size_t r = 0; r < rows; ++r) {
+        const bool last_row = r + 1 == rows;
+
+        /* the rooms, joined sideways at random - on the last row always,
+         * so that everything ends up connected */
+        clear_row(row, false);
+        for (size_t c = 0; c + 1 < rooms; ++c) {
+            bool apart = !sets.same(set[c], set[c+1]);
+            if (apart && (last_row || rng() & 1)) {
+                sets.unite(set[c], set[c+1]);
+            } else {
+                row.set(2*c + 2, 0, true, subtype(WallTypes::INNER));
+            }
+        }
+        sink(2*r + 1, row);
+
+        if (last_row) {
+            border_row(row);
+            sink(2*r + 2, row);
+            break;
+        }
+
+        /* the walls below - every set goes down at least once */
+        for (size_t c = 0; c < rooms; ++c) { downs[sets.find(set[c])] = 0; }
+        for (size_t c = 0; c < rooms; ++c) {
+            auto root = sets.find(set[c]);
+            down[c] = rng() & 1;
+            downs[root] += down[c];
+            last[root] = std::uint32_t(c);
+        }
+        clear_row(row, true);
+        for (size_t c = 0; c < rooms; ++c) {
+            auto root = sets.find(set[c]);
+            if (!downs[root] && last[root] == c) { down[c] = 1; }
+            if (down[c]) {
+                row.set(2*c + 1, 0, false, subtype(PathTypes::NORMAL));
+            }
+        }
+        sink(2*r + 2, row);
+
+        /* carry the sets that went down, new sets for the rest */
+        for (size_t c = 0; c < rooms; ++c) {
+            renumber[sets.find(set[c])] = NO_SET;
+        }
+        std::uint32_t count = 0;
+        for (size_t c = 0; c < rooms; ++c) {
+            if (!down[c]) { continue; }
+            auto root = sets.find(set[c]);
+            if (renumber[root] == NO_SET) { renumber[root] = count++; }
+            set[c] = renumber[root];
+        }
+        for (size_t c = 0; c < rooms; ++c) {
+            if (!down[c]) { set[c] = count++; }
+        }
+        sets.reset(rooms);
+    }
+}
+
+BitGrid
+EllerGenerator::generate() const
+{
+    BitGrid grid(width, height);
+    generate([&](size_t y, const BitGrid& row) { grid.copyRow(y, row, 0); });
+    return grid;
+}
+
+RowWriter::RowWriter(std::ostream& out, size_t width, size_t height)
+    : out(out)
+    , words_per_row((width + BitGrid::WORD_BITS - 1) / BitGrid::WORD_BITS)
+{
+    std::uint64_t dims[2] = { width, height };
+    out.write(ROW_MAGIC, sizeof(ROW_MAGIC));
+    out.write(reinterpret_cast<const char*>(dims), sizeof(dims));
+}
+
+void
+RowWriter::operator()(size_t /* y */, const BitGrid& row) const
+{
+    const std::streamsize bytes = words_per_row * sizeof(BitGrid::word_type);
+    out.get().write(reinterpret_cast<const char*>(row.wallRow(0)), bytes);
+    for (size_t p = 0; p < BitGrid::SUBTYPE_PLANES; ++p) {
+        out.get().write(
+                reinterpret_cast<const char*>(row.subtypeRow(p, 0)), bytes);
+    }
+    if (!out.get()) {
+        throw err::io_error() << err::reason("writing a row failed");
+    }
+}
+
+BitGrid
+read_rows(std::istream& in)
+{
+    size_t width, height;
+    if (read_header(in, width, height)) {
+        BitGrid grid(width, height);
+        for (size_t y = 0; y < height; ++y) {
+            read_row(in, grid, y);
+        }
+        return grid;
+    }
+
+    // the length is unknown: gather the words as they come, a piece at a
+    // time, and make the grid once they all did
+    typedef BitGrid::word_type word_type;
+    const size_t PIECE = 1 << 16;
+    std::vector<word_type> words;
+    for (size_t left = height * row_words(width); left > 0; ) {
+        const size_t n = std::min(left, PIECE);
+        words.resize(words.size() + n);
+        in.read(reinterpret_cast<char*>(&words[words.size() - n]),
+                n * sizeof(word_type));
+        if (!in) {
+            throw err::bad_format() << err::reason("row file is truncated");
+        }
+        left -= n;
+    }
+    BitGrid grid(width, height);
+    const size_t wpr = grid.getWordsPerRow();
+    const word_type* w = words.data();
+    for (size_t y = 0; y < height; ++y, w += wpr) {
+        std::copy(w, w + wpr, grid.wallRow(y));
+        for (size_t p = 0; p < BitGrid::SUBTYPE_PLANES; ++p) {
+            w += wpr;
+            std::copy(w, w + wpr, grid.subtypeRow(p, y));
+        }
+    }
+    return grid;
+}
+
+BitGrid
+read_rows(std::istream& in, size_t x0, size_t y0, size_t w, size_t h)
+{
+    size_t width, height;
+    if (!read_header(in, width, height)) {
+        throw err::io_error() << err::reason("row file is not seekable");
+    }
+    x0 = std::min(x0, width);
+    y0 = std::min(y0, height);
+    const size_t x1 = x0 + std::min(w, width  - x0);
+    const size_t y1 = y0 + std::min(h, height - y0);
+
+    BitGrid window(x1 - x0, y1 - y0);
+    BitGrid row(width, 1);
+    in.seekg(y0 * row_words(width) * sizeof(BitGrid::word_type),
+             std::ios_base::cur);
+    for (size_t y = y0; y < y1; ++y) {
+        read_row(in, row, 0);
+        for (size_t x = x0; x < x1; ++x) {
+            window.set(x - x0, y - y0, row.isWall(x, 0), row.getSubtype(x, 0));
+        }
+    }
+    return window;
+}
+
+} // end namespace maps
@@ -0,0 +1,96 @@
+#ifndef ELLER_HPP_GUARD
+#define ELLER_HPP_GUARD
+/**
+ * @file eller.hpp
+ * Streaming, row by row maze generation.
+ *
+ * @since 2026-10-17
+ */
+
+#include "bitgrid.hpp"
+#include "exceptions.hpp"
+#include "../misc/random.hpp"
+
+#include <cstdint>
+#include <functional>
+#include <iosfwd>
+
+namespace maps {
+
+/**
+ * Generates a perfect maze one row at a time with Eller's algorithm.
+ *
+ * Only O(width) state is kept, so the maze can be far larger than memory as
+ * long as the rows go somewhere else - a file, a socket, a tile cache.
+ * Rows use the same encoding as Maze: BitGrid rows where walls are
+ * WallTypes::BORDER around the edge and WallTypes::INNER inside, and paths
+ * are PathTypes::NORMAL. Rooms are the odd,odd cells, as in Maze.
+ */
+class EllerGenerator {
+    public:
+    /** receives row y, a one row BitGrid that is reused between calls */
+    typedef std::function<void(size_t y, const BitGrid& row)> row_sink;
+
+    private:
+    size_t width;
+    size_t height;
+    std::uint64_t seed;
+
+    public:
+    /** width and height are rounded to odd numbers, like in Maze. */
+    EllerGenerator(size_t width, size_t height,
+                   std::uint64_t seed = utility::generator::DEFAULT_SEED)
+        : width( (width/2)  * 2 + 1)
+        , height((height/2) * 2 + 1)
+        , seed(seed)
+    {}
+
+    /** Emits all rows, top to bottom, into sink. */
+    void generate(const row_sink& sink) const;
+
+    /** Collects the whole maze into a grid, e.g. to make a Maze of it. */
+    BitGrid generate() const;
+
+    size_t getWidth()  const { return width; }
+    size_t getHeight() const { return height; }
+};
+
+/**
+ * A row_sink that writes rows to a stream in the raw row format:
+ * "HXRW", width and height as 64 bit words, then every row as its wall
+ * words followed by the words of each subtype plane, all in the byte order
+ * of the machine that wrote them.
+ */
+class RowWriter {
+    std::reference_wrapper<std::ostream> out;
+    size_t words_per_row;
+
+    public:
+    RowWriter(std::ostream& out, size_t width, size_t height);
+
+    void operator()(size_t y, const BitGrid& row) const;
+};
+
+/**
+ * Reads a whole raw row file back into a grid. The size in the header is
+ * checked against what a seekable stream holds before the grid is
+ * allocated; other streams are read to the end first, so a corrupt header
+ * costs no more memory than the rows that really arrive.
+ *
+ * @throw err::bad_format if the header is corrupt or the rows are short
+ */
+BitGrid read_rows(std::istream& in);
+
+/**
+ * Reads the window [x0, x0+w) x [y0, y0+h) of a raw row file, seeking
+ * past the rows outside of it - a tiled view of a maze too big to load.
+ * The window is clipped to the maze. The stream must be seekable.
+ *
+ * @throw err::bad_format if the header is corrupt or the rows are short
+ */
+BitGrid read_rows(std::istream& in,
+                  size_t x0, size_t y0, size_t w, size_t h);
+
+} // end namespace maps
+
+#endif
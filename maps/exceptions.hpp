@@ -0,0 +1,24 @@
+#ifndef MAPS_EXCEPTIONS_HPP
+#define MAPS_EXCEPTIONS_HPP
+/**
+ * @file exceptions.hpp
+ * Errors raised by the maps library.
+ *
+ * @since 2026-10-17
+ */
+#include <string>
+#include <boost/exception/all.hpp>
+
+namespace maps {
+namespace err {
+
+    struct exception_base : virtual std::exception, virtual boost::exception {};
+    struct io_error       : virtual exception_base {};
+    struct bad_format     : virtual exception_base {};
+    typedef boost::error_info<struct tag_file_name, std::string> file_name;
+    typedef boost::error_info<struct tag_reason, std::string> reason;
+
+}
+}
+
+#endif
@@ -0,0 +1,300 @@
+#ifndef FIXED_MAZE_HPP_GUARD
+#define FIXED_MAZE_HPP_GUARD
+/**
+ * @file fixed_maze.hpp
+ * A maze whose size is fixed at compile time, for small arenas.
+ *
+ * @since 2026-10-17
+ */
+
+#include "maze.hpp"
+#include "random_walls.hpp"
+#include "../misc/utility.hpp"
+
+#include <algorithm>
+#include <array>
+#include <cassert>
+#include <cstdint>
+#include <utility>
+
+namespace maps {
+
+/**
+ * A W x H maze stored inline: the wall rows live in a std::array, packed
+ * 64 cells to a word like BitGrid's, and the dimensions are constants, so
+ * making, copying and querying one never allocates and the index math
+ * folds at compile time.
+ *
+ * It has the part of Maze's interface the engine uses (the maze
+ * interface): getWidth(), getHeight(), isWall(), isPath(), isPathBatch(),
+ * getStart() and getFinish(). Code that takes the maze as a template
+ * parameter, like engine::basic_engine, works with either.
+ *
+ * A generated FixedMaze has the walls, start and finish Maze's serial
+ * generator (threads = 0) makes from the same seed. It places no objects,
+ * but makes the random draws Maze spends on them and drops them, so start
+ * and finish are drawn at the same point of the sequence.
+ */
+template <size_t W, size_t H>
+class FixedMaze {
+    static_assert(W % 2 == 1 && H % 2 == 1 && W >= 3 && H >= 3,
+                  "mazes have odd sides of at least 3 cells");
+
+    public:
+    typedef BitGrid::word_type word_type;
+    typedef std::pair<size_t, size_t> cell;
+
+    static const size_t WORD_BITS = 64;
+    static const size_t WORDS_PER_ROW = (W + WORD_BITS - 1) / WORD_BITS;
+
+    private:
+    /** H rows of WORDS_PER_ROW words; padding bits past W are walls */
+    std::array<word_type, H * WORDS_PER_ROW> walls;
+    std::uint64_t seed;
+    double difficulty;
+    cell start;
+    cell finish;
+
+    static inline size_t
+    index(size_t x, size_t y) { return y * WORDS_PER_ROW + x / WORD_BITS; }
+
+    inline void
+    setWall(size_t x, size_t y) {
+        walls[index(x, y)] |= word_type(1) << (x % WORD_BITS);
+    }
+
+    static bool
+    is_in_center_third(size_t x, size_t y) {
+        const size_t row_third = (W - 1) / 3, col_third = (H - 1) / 3;
+        return (row_third < x && x < 2*row_third) &&
+               (col_third < y && y < 2*col_third);
+    }
+
+    static cell
+    quadrant(size_t x, size_t y) {
+        return cell(x / ((W - 1) / 2), y / ((H - 1) / 2));
+    }
+
+    /**
+     * Draws one of the inner cells that pass test, the way picking from
+     * the list of them would, without making the list.
+     */
+    template <typename Generator, typename Test>
+    static bool
+    pick(Generator& rng, Test test, cell& picked) {
+        size_t n = 0;
+        for (size_t y = 1; y + 1 < H; ++y) {
+            for (size_t x = 1; x + 1 < W; ++x) { n += test(x, y); }
+        }
+        if (n == 0) { return false; }
+        size_t k = utility::rand(rng, 0, n);
+        for (size_t y = 1; y + 1 < H; ++y) {
+            for (size_t x = 1; x + 1 < W; ++x) {
+                if (test(x, y) && k-- == 0) {
+                    picked = cell(x, y);
+                    return true;
+                }
+            }
+        }
+        return false;
+    }
+
+    /**
+     * The path cells reachable from start, as wall-like rows. Grows the
+     * set by a step in every direction, a word at a time, until it stops
+     * changing - quadratic for long corridors, but the arenas are small.
+     */
+    std::array<word_type, H * WORDS_PER_ROW>
+    reachable_from(cell from) const {
+        std::array<word_type, H * WORDS_PER_ROW> reach;
+        reach.fill(0);
+        reach[index(from.first, from.second)] |=
+            word_type(1) << (from.first % WORD_BITS);
+        for (bool changed = true; changed; ) {
+            changed = false;
+            for (size_t y = 1; y + 1 < H; ++y) {
+                for (size_t k = 0; k < WORDS_PER_ROW; ++k) {
+                    const size_t i = y * WORDS_PER_ROW + k;
+                    word_type grown = reach[i] | reach[i] << 1 | reach[i] >> 1
+                                    | reach[i - WORDS_PER_ROW]
+                                    | reach[i + WORDS_PER_ROW];
+                    if (k > 0) { grown |= reach[i - 1] >> (WORD_BITS - 1); }
+                    if (k + 1 < WORDS_PER_ROW) {
+                        grown |= reach[i + 1] << (WORD_BITS - 1);
+                    }
+                    grown &= ~walls[i];
+                    if (grown != reach[i]) {
+                        reach[i] = grown;
+                        changed = true;
+                    }
+                }
+            }
+        }
+        return reach;
+    }
+
+    /**
+     * Makes the draws of Maze's object placement: a shuffle of the blind
+     * ends (path cells with one open neighbor out of eight), then a cell
+     * for each of 39 wandering monsters.
+     */
+    template <typename Generator>
+    void
+    skip_objects(Generator& rng) const {
+        size_t blind_ends = 0;
+        for (size_t y = 1; y + 1 < H; ++y) {
+            for (size_t x = 1; x + 1 < W; ++x) {
+                if (isWall(x, y)) { continue; }
+                unsigned int open = 0;
+                for (size_t j = y - 1; j <= y + 1; ++j) {
+                    for (size_t i = x - 1; i <= x + 1; ++i) {
+                        open += isPath(i, j);
+                    }
+                }
+                blind_ends += open == 2; // the cell itself and its exit
+            }
+        }
+        for (size_t i = blind_ends; i > 1; --i) { utility::rand(rng, 0, i); }
+        for (size_t i = 1; i < 40; ++i) {
+            utility::rand(rng, 1, W - 1);
+            utility::rand(rng, 1, H - 1);
+        }
+    }
+
+    template <typename Generator>
+    void
+    place_start_and_finish(Generator& rng) {
+        start = cell(1, 1);
+        if (!pick(rng, [this](size_t x, size_t y) {
+                      return isPath(x, y) && !is_in_center_third(x, y);
+                  }, start)) {
+            pick(rng, [this](size_t x, size_t y) { return isPath(x, y); },
+                 start);
+        }
+        finish = start;
+        if (!isPath(start.first, start.second)) { return; }
+
+        // the finish has to be reachable from the start
+        const auto reach = reachable_from(start);
+        const cell s = start, start_quadrant = quadrant(s.first, s.second);
+        auto away = [&](size_t x, size_t y) {
+            return ((reach[index(x, y)] >> (x % WORD_BITS)) & 1) &&
+                   cell(x, y) != s;
+        };
+        if (pick(rng, [&](size_t x, size_t y) {
+                     return away(x, y) && !is_in_center_third(x, y) &&
+                            quadrant(x, y) != start_quadrant;
+                 }, finish)) {
+            return;
+        }
+        if (pick(rng, [&](size_t x, size_t y) {
+                     return away(x, y) && !is_in_center_third(x, y);
+                 }, finish)) {
+            return;
+        }
+        pick(rng, away, finish);
+    }
+
+    public:
+    /** Generates a maze; the same seed always produces the same maze. */
+    explicit FixedMaze(double difficulty,
+                       std::uint64_t seed = utility::generator::DEFAULT_SEED)
+        : walls()
+        , seed(seed)
+        , difficulty(difficulty)
+        , start(0, 0)
+        , finish(0, 0)
+    {
+        walls.fill(0);
+        for (size_t y = 0; y < H; ++y) {
+            for (size_t x = W; x < WORDS_PER_ROW * WORD_BITS; ++x) {
+                setWall(x, y);
+            }
+        }
+        for (size_t i = 0; i < W; ++i) {
+            setWall(i, 0);
+            setWall(i, H - 1);
+        }
+        for (size_t j = 0; j < H; ++j) {
+            setWall(0, j);
+            setWall(W - 1, j);
+        }
+        utility::generator rng(seed);
+        random_walls(W, H, rng, 0.75, 0.75,
+                     [this](size_t x, size_t y) { return isPath(x, y); },
+                     [this](size_t x, size_t y) { setWall(x, y); });
+        skip_objects(rng);
+        place_start_and_finish(rng);
+    }
+
+    /** Copies the walls, start and finish of a W x H maze. */
+    explicit FixedMaze(const Maze& maze)
+        : walls()
+        , seed(maze.getSeed())
+        , difficulty(maze.getDifficulty())
+        , start(maze.getStart())
+        , finish(maze.getFinish())
+    {
+        assert(maze.getWidth() == W);
+        assert(maze.getHeight() == H);
+        for (size_t y = 0; y < H; ++y) {
+            std::copy(maze.wallRow(y), maze.wallRow(y) + WORDS_PER_ROW,
+                      walls.begin() + y * WORDS_PER_ROW);
+        }
+    }
+
+    static constexpr size_t getWidth()  { return W; }
+    static constexpr size_t getHeight() { return H; }
+
+    inline bool
+    isWall(size_t x, size_t y) const {
+        assert(x < W);
+        assert(y < H);
+        return (walls[index(x, y)] >> (x % WORD_BITS)) & 1;
+    }
+
+    inline bool
+    isPath(size_t x, size_t y) const { return !isWall(x, y); }
+
+    /** See Maze::isPathBatch(). */
+    void
+    isPathBatch(const double* xs, const double* ys, size_t n,
+                std::uint64_t* mask) const {
+        for (size_t base = 0; base < n; base += 64) {
+            const size_t count = std::min<size_t>(64, n - base);
+            std::uint64_t bits = 0;
+            for (size_t i = 0; i < count; ++i) {
+                const double x = xs[base + i], y = ys[base + i];
+                // false for NaN too
+                const bool inside = x >= 0 && y >= 0 && x < W && y < H;
+                const size_t cx = inside ? size_t(x) : 0;
+                const size_t cy = inside ? size_t(y) : 0;
+                const word_type wall = walls[index(cx, cy)] >> (cx % 64);
+                bits |= std::uint64_t(inside & !(wall & 1)) << i;
+            }
+            mask[base / 64] = bits;
+        }
+    }
+
+    /** Wall bits of row y, laid out like Maze::wallRow(). */
+    inline const word_type*
+    wallRow(size_t y) const {
+        assert(y < H);
+        return &walls[y * WORDS_PER_ROW];
+    }
+
+    std::uint64_t getSeed() const { return seed; }
+    double getDifficulty() const { return difficulty; }
+
+    cell getStart() const { return start; }
+    cell getFinish() const { return finish; }
+};
+
+template <size_t W, size_t H>
+const size_t FixedMaze<W, H>::WORD_BITS;
+template <size_t W, size_t H>
+const size_t FixedMaze<W, H>::WORDS_PER_ROW;
+
+} // end namespace maps
+
+#endif
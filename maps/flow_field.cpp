@@ -0,0 +1,182 @@
+/**
+ * @file flow_field.cpp
+ * Distance and next-step fields towards a set of target cells.
+ *
+ * @since 2026-10-17
+ */
+
+#include "flow_field.hpp"
+
+#include <algorithm>
+#include <iterator>
+
+namespace maps {
+
+const FlowField::distance_type FlowField::UNREACHABLE;
+const std::uint32_t FlowField::NO_OWNER;
+
+FlowField::FlowField(const Maze& maze)
+    : maze(maze)
+    , width(maze.getWidth())
+    , height(maze.getHeight())
+    , dist(width * height, UNREACHABLE)
+    , dir(width * height, Direction::NONE)
+    , owner(width * height, NO_OWNER)
+    , targets()
+    , target_ids()
+    , queue(width * height)
+    , seeds()
+    , next_ids()
+    , removed()
+    , added()
+{}
+
+void
+FlowField::collect(const std::vector<cell>& cells,
+                   std::vector<std::uint32_t>& ids) const
+{
+    ids.clear();
+    for (auto& c : cells) {
+        if (maze.get().isPath(c.first, c.second)) {
+            ids.push_back(std::uint32_t(c.second * width + c.first));
+        }
+    }
+    std::sort(ids.begin(), ids.end());
+    ids.erase(std::unique(ids.begin(), ids.end()), ids.end());
+}
+
+/**
+ * Breadth first search from the seeds, which are sorted by distance.
+ *
+ * The seeds are merged with the FIFO frontier so that cells are expanded
+ * in order of distance; a cell is then improved at most once, so the
+ * frontier never outgrows the grid. Seeds whose distance improved since
+ * they were queued are stale and skipped.
+ */
+void
+FlowField::propagate()
+{
+    const BitGrid& grid = maze.get().getGrid();
+    size_t head = 0, tail = 0, s = 0;
+
+    while (head < tail || s < seeds.size()) {
+        std::uint32_t u;
+        if (s < seeds.size() &&
+                (head == tail || seeds[s].first <= dist[queue[head]])) {
+            auto seed = seeds[s++];
+            if (dist[seed.second] != seed.first) { continue; }
+            u = seed.second;
+        } else {
+            u = queue[head++];
+        }
+
+        const size_t x = u % width, y = u / width;
+        const distance_type d = dist[u] + 1;
+        auto relax = [&](std::uint32_t v, size_t vx, size_t vy,
+                         Direction back) {
+            if (d < dist[v] && !grid.isWall(vx, vy)) {
+                dist[v]  = d;
+                owner[v] = owner[u];
+                dir[v]   = back;
+                queue[tail++] = v;
+            }
+        };
+        if (x + 1 < width)  { relax(u + 1,     x+1, y, Direction::WEST);  }
+        if (x > 0)          { relax(u - 1,     x-1, y, Direction::EAST);  }
+        if (y + 1 < height) { relax(u + width, x, y+1, Direction::NORTH); }
+        if (y > 0)          { relax(u - width, x, y-1, Direction::SOUTH); }
+    }
+    seeds.clear();
+}
+
+void
+FlowField::setTargets(const std::vector<cell>& new_targets)
+{
+    std::fill(dist.begin(),  dist.end(),  UNREACHABLE);
+    std::fill(dir.begin(),   dir.end(),   Direction::NONE);
+    std::fill(owner.begin(), owner.end(), NO_OWNER);
+    targets.clear();
+    seeds.clear();
+
+    collect(new_targets, target_ids);
+    for (auto i : target_ids) {
+        targets.push_back(cell(i % width, i / width));
+        dist[i]  = 0;
+        owner[i] = i;
+        seeds.push_back(std::make_pair(0, i));
+    }
+    propagate();
+}
+
+void
+FlowField::retarget(const std::vector<cell>& new_targets)
+{
+    // both lists without duplicates, or a target listed twice before and
+    // once after would count as removed
+    collect(new_targets, next_ids);
+    removed.clear();
+    added.clear();
+    std::set_difference(target_ids.begin(), target_ids.end(),
+                        next_ids.begin(),   next_ids.end(),
+                        std::back_inserter(removed));
+    std::set_difference(next_ids.begin(),   next_ids.end(),
+                        target_ids.begin(), target_ids.end(),
+                        std::back_inserter(added));
+
+    /* forget the cells of the removed targets. A target's cells are
+     * connected - each steps to a neighbor of the same target - so a flood
+     * fill from the target finds them all. */
+    size_t invalid = 0;
+    for (auto r : removed) {
+        size_t first = invalid;
+        dist[r] = UNREACHABLE;
+        owner[r] = NO_OWNER;
+        queue[invalid++] = r;
+        for (size_t i = first; i < invalid; ++i) {
+            std::uint32_t u = queue[i];
+            dir[u] = Direction::NONE;
+            size_t x = u % width, y = u / width;
+            auto forget = [&](std::uint32_t v) {
+                if (owner[v] == r) {
+                    dist[v] = UNREACHABLE;
+                    owner[v] = NO_OWNER;
+                    queue[invalid++] = v;
+                }
+            };
+            if (x + 1 < width)  { forget(u + 1); }
+            if (x > 0)          { forget(u - 1); }
+            if (y + 1 < height) { forget(u + width); }
+            if (y > 0)          { forget(u - width); }
+        }
+    }
+
+    /* regrow them from the cells around them that kept their distance,
+     * and from the new targets */
+    for (size_t i = 0; i < invalid; ++i) {
+        std::uint32_t u = queue[i];
+        size_t x = u % width, y = u / width;
+        auto edge = [&](std::uint32_t v) {
+            if (dist[v] != UNREACHABLE) {
+                seeds.push_back(std::make_pair(dist[v], v));
+            }
+        };
+        if (x + 1 < width)  { edge(u + 1); }
+        if (x > 0)          { edge(u - 1); }
+        if (y + 1 < height) { edge(u + width); }
+        if (y > 0)          { edge(u - width); }
+    }
+    for (auto a : added) {
+        dist[a]  = 0;
+        owner[a] = a;
+        dir[a]   = Direction::NONE;
+        seeds.push_back(std::make_pair(0, a));
+    }
+    std::sort(seeds.begin(), seeds.end());
+    propagate();
+
+    target_ids.swap(next_ids);
+    targets.clear();
+    for (auto a : target_ids) { targets.push_back(cell(a % width, a / width)); }
+}
+
+} // end namespace maps
@@ -0,0 +1,120 @@
+#ifndef FLOW_FIELD_HPP_GUARD
+#define FLOW_FIELD_HPP_GUARD
+/**
+ * @file flow_field.hpp
+ * Distance and next-step fields towards a set of target cells.
+ *
+ * @since 2026-10-17
+ */
+
+#include "maze.hpp"
+
+#include <cstdint>
+#include <functional>
+#include <utility>
+#include <vector>
+
+namespace maps {
+
+/**
+ * Breadth first distances from every path cell to the nearest of a set of
+ * targets (players, the finish), together with the direction of the next
+ * step along a shortest path. Any number of monsters can then navigate with
+ * one lookup per tick each.
+ *
+ * Movement is 4-connected. The field does not follow changes to the maze;
+ * call setTargets() again after editing it.
+ */
+class FlowField {
+    public:
+    typedef std::uint32_t distance_type;
+    typedef std::pair<size_t, size_t> cell;
+
+    static const distance_type UNREACHABLE = ~distance_type(0);
+
+    enum class Direction : std::uint8_t {
+        NONE,   // a target, a wall, or no target reachable
+        EAST,   // x+1
+        WEST,   // x-1
+        SOUTH,  // y+1
+        NORTH   // y-1
+    };
+
+    private:
+    static const std::uint32_t NO_OWNER = ~std::uint32_t(0);
+
+    std::reference_wrapper<const Maze> maze;
+    size_t width;
+    size_t height;
+
+    std::vector<distance_type> dist;
+    std::vector<Direction> dir;
+    /** cell index of the target each cell's distance is measured to */
+    std::vector<std::uint32_t> owner;
+    std::vector<cell> targets;
+    /** cell indices of the targets, sorted, without duplicates */
+    std::vector<std::uint32_t> target_ids;
+
+    /**
+     * reused between updates, so that once they have grown to the number
+     * of targets retargeting allocates nothing
+     */
+    std::vector<std::uint32_t> queue;
+    std::vector<std::pair<distance_type, std::uint32_t>> seeds;
+    std::vector<std::uint32_t> next_ids;
+    std::vector<std::uint32_t> removed;
+    std::vector<std::uint32_t> added;
+
+    void propagate();
+    /** the path cells of cells into ids, sorted, without duplicates */
+    void collect(const std::vector<cell>& cells,
+                 std::vector<std::uint32_t>& ids) const;
+
+    public:
+    explicit FlowField(const Maze& maze);
+
+    /** Recomputes the whole field for the given targets. */
+    void setTargets(const std::vector<cell>& targets);
+
+    /**
+     * Moves the targets to a new set, touching only the cells whose
+     * distance changes - the ones nearest to a target that moved or
+     * disappeared, and the ones a new target is now nearer to. When
+     * targets only shift a few cells, most of the field is untouched.
+     */
+    void retarget(const std::vector<cell>& targets);
+
+    inline distance_type
+    distance(size_t x, size_t y) const {
+        assert(x < width);
+        assert(y < height);
+        return dist[y * width + x];
+    }
+
+    /** Which way to step from (x, y) to get closer to a target. */
+    inline Direction
+    next(size_t x, size_t y) const {
+        assert(x < width);
+        assert(y < height);
+        return dir[y * width + x];
+    }
+
+    /** The cell one step closer to a target; (x, y) itself on a target. */
+    inline cell
+    nextCell(size_t x, size_t y) const {
+        switch (next(x, y)) {
+            case Direction::EAST:  return cell(x+1, y);
+            case Direction::WEST:  return cell(x-1, y);
+            case Direction::SOUTH: return cell(x, y+1);
+            case Direction::NORTH: return cell(x, y-1);
+            default:               return cell(x, y);
+        }
+    }
+
+    /** The targets on path cells, each once, in row major order. */
+    const std::vector<cell>& getTargets() const { return targets; }
+};
+
+} // end namespace maps
+
+#endif
@@ -0,0 +1,117 @@
+#ifndef GRID_LAYOUT_HPP_GUARD
+#define GRID_LAYOUT_HPP_GUARD
+/**
+ * @file grid_layout.hpp
+ * Where the bit of each cell lives in a BasicBitGrid's 64 bit words.
+ *
+ * A layout is made for a width and height and maps a cell to a word and a
+ * bit in it. It also says how far it pads the grid; the padding cells are
+ * walls.
+ *
+ * RowMajor packs 64 cells of a row per word and is what the word-parallel
+ * row operations (BitGrid::wallWord and friends) need. The other two keep
+ * cells that are close in both directions close in memory, which suits
+ * code that walks the grid cell by cell in all directions - floods,
+ * neighborhood scans - on mazes so wide that the rows above and below no
+ * longer share cache lines.
+ *
+ * @since 2026-10-17
+ */
+
+#include <cstddef>
+
+namespace maps {
+
+/** Rows of 64 cell words. */
+struct RowMajor {
+    static const bool ROW_WORDS = true;
+
+    size_t words_per_row;
+    size_t height;
+
+    RowMajor(size_t width, size_t height)
+        : words_per_row((width + 63) / 64)
+        , height(height)
+    {}
+
+    size_t words()        const { return words_per_row * height; }
+    size_t paddedWidth()  const { return words_per_row * 64; }
+    size_t paddedHeight() const { return height; }
+
+    inline size_t
+    word(size_t x, size_t y) const { return y * words_per_row + x / 64; }
+
+    static inline unsigned int
+    bit(size_t x, size_t) { return x % 64; }
+};
+
+/** A word per 8x8 tile of cells, the tiles in rows. */
+struct Tiled8x8 {
+    static const bool ROW_WORDS = false;
+
+    size_t tiles_x;
+    size_t tiles_y;
+
+    Tiled8x8(size_t width, size_t height)
+        : tiles_x((width + 7) / 8)
+        , tiles_y((height + 7) / 8)
+    {}
+
+    size_t words()        const { return tiles_x * tiles_y; }
+    size_t paddedWidth()  const { return tiles_x * 8; }
+    size_t paddedHeight() const { return tiles_y * 8; }
+
+    inline size_t
+    word(size_t x, size_t y) const { return (y / 8) * tiles_x + x / 8; }
+
+    static inline unsigned int
+    bit(size_t x, size_t y) { return (y % 8) * 8 + x % 8; }
+};
+
+/**
+ * Z-order (Morton) curve within 64x64 blocks, the blocks in rows. Padding
+ * the whole grid to a power of two square would waste most of a long thin
+ * maze, and beyond 64x64 cells (512 bytes) the curve buys no more locality.
+ */
+struct Morton {
+    static const bool ROW_WORDS = false;
+
+    size_t blocks_x;
+    size_t blocks_y;
+
+    Morton(size_t width, size_t height)
+        : blocks_x((width + 63) / 64)
+        , blocks_y((height + 63) / 64)
+    {}
+
+    size_t words()        const { return blocks_x * blocks_y * 64; }
+    size_t paddedWidth()  const { return blocks_x * 64; }
+    size_t paddedHeight() const { return blocks_y * 64; }
+
+    /** v's bits spread to the even bits */
+    static inline unsigned int
+    spread(unsigned int v) {
+        v = (v | (v << 4)) & 0x0f0fu;
+        v = (v | (v << 2)) & 0x3333u;
+        v = (v | (v << 1)) & 0x5555u;
+        return v;
+    }
+
+    /** position of the cell in its block's curve, 0 .. 4095 */
+    static inline unsigned int
+    code(size_t x, size_t y) {
+        return spread(x % 64) | (spread(y % 64) << 1);
+    }
+
+    inline size_t
+    word(size_t x, size_t y) const {
+        return ((y / 64) * blocks_x + x / 64) * 64 + code(x, y) / 64;
+    }
+
+    static inline unsigned int
+    bit(size_t x, size_t y) { return code(x, y) % 64; }
+};
+
+} // end namespace maps
+
+#endif
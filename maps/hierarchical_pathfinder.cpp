@@ -0,0 +1,344 @@
+/**
+ * @file hierarchical_pathfinder.cpp
+ * HPA*: path planning over clusters of the maze.
+ *
+ * @since 2026-10-17
+ */
+
+#include "hierarchical_pathfinder.hpp"
+#include "stamped_set.hpp"
+
+#include <algorithm>
+#include <cstdlib>
+
+namespace maps {
+
+namespace {
+struct Node {
+    std::uint32_t f;
+    std::uint32_t cell;
+    bool operator<(const Node& o) const { return f > o.f; } // min-heap
+};
+
+/** Abstract search state of one thread, reused by all its queries. */
+struct Workspace {
+    std::vector<std::uint32_t> g;
+    std::vector<std::uint32_t> parent;
+    StampedSet seen;
+    StampedSet closed;
+    std::vector<Node> open;
+    /** BFS distances from the start and the goal inside their clusters */
+    std::vector<std::uint32_t> start_dist;
+    std::vector<std::uint32_t> goal_dist;
+
+    Workspace()
+        : g(), parent(), seen(), closed(), open(), start_dist(), goal_dist()
+    {}
+
+    void
+    begin(size_t n)
+    {
+        if (g.size() != n) {
+            g.resize(n);
+            parent.resize(n);
+        }
+        seen.clear(n);
+        closed.clear(n);
+        open.clear();
+    }
+};
+
+thread_local Workspace workspace;
+} // end anonymous namespace
+
+const std::uint32_t HierarchicalPathfinder::NONE;
+const size_t HierarchicalPathfinder::LONG_ENTRANCE;
+
+HierarchicalPathfinder::HierarchicalPathfinder(const Maze& maze,
+                                               size_t cluster_size)
+    : maze(maze)
+    , width(maze.getWidth())
+    , height(maze.getHeight())
+    , cluster_size(std::max<size_t>(cluster_size, 2))
+    , clusters_x((width  + this->cluster_size - 1) / this->cluster_size)
+    , clusters_y((height + this->cluster_size - 1) / this->cluster_size)
+    , clusters(clusters_x * clusters_y)
+    , node_index(width * height, NONE)
+{
+    rebuild();
+}
+
+/**
+ * A maximal run of path cells facing path cells across a border is one
+ * entrance. Both clusters scan the same run, so they agree on where its
+ * transition is without talking to each other.
+ */
+void
+HierarchicalPathfinder::entrances(size_t k,
+                                  std::vector<std::uint32_t>& out) const
+{
+    const Maze& m = maze.get();
+    const size_t kx = k % clusters_x, ky = k / clusters_x;
+    const size_t x0 = kx * cluster_size, x1 = std::min(width,  x0 + cluster_size);
+    const size_t y0 = ky * cluster_size, y1 = std::min(height, y0 + cluster_size);
+
+    // the border between column (or row) own and across, for t in [lo, hi)
+    auto scan = [&](bool column, size_t own, size_t across,
+                    size_t lo, size_t hi) {
+        auto open = [&](size_t t) {
+            return column ? m.isPath(own, t) && m.isPath(across, t)
+                          : m.isPath(t, own) && m.isPath(t, across);
+        };
+        auto add = [&](size_t t) {
+            out.push_back(std::uint32_t(column ? t * width + own
+                                               : own * width + t));
+        };
+        for (size_t t = lo; t < hi; ) {
+            if (!open(t)) { ++t; continue; }
+            size_t start = t;
+            while (t < hi && open(t)) { ++t; }
+            if (t - start >= LONG_ENTRANCE) {
+                add(start);
+                add(t - 1);
+            } else {
+                add(start + (t - start - 1) / 2);
+            }
+        }
+    };
+    if (kx > 0)              { scan(true,  x0,     x0 - 1, y0, y1); }
+    if (kx + 1 < clusters_x) { scan(true,  x1 - 1, x1,     y0, y1); }
+    if (ky > 0)              { scan(false, y0,     y0 - 1, x0, x1); }
+    if (ky + 1 < clusters_y) { scan(false, y1 - 1, y1,     x0, x1); }
+}
+
+void
+HierarchicalPathfinder::flood(size_t k, std::uint32_t c,
+                              std::vector<std::uint32_t>& dist,
+                              std::vector<std::uint32_t>* parent) const
+{
+    thread_local std::vector<std::uint32_t> queue;
+    const Maze& m = maze.get();
+    const size_t C = cluster_size;
+    const size_t x0 = k % clusters_x * C, y0 = k / clusters_x * C;
+    const size_t w = std::min(width - x0, C), h = std::min(height - y0, C);
+
+    dist.assign(C * C, NONE);
+    if (parent) { parent->resize(C * C); }
+    queue.clear();
+    std::uint32_t s = std::uint32_t((c / width - y0) * C + (c % width - x0));
+    dist[s] = 0;
+    queue.push_back(s);
+    for (size_t head = 0; head < queue.size(); ++head) {
+        const std::uint32_t u = queue[head];
+        const size_t x = u % C, y = u / C;
+        auto relax = [&](std::uint32_t v, size_t vx, size_t vy) {
+            if (dist[v] == NONE && m.isPath(x0 + vx, y0 + vy)) {
+                dist[v] = dist[u] + 1;
+                if (parent) { (*parent)[v] = u; }
+                queue.push_back(v);
+            }
+        };
+        if (x + 1 < w) { relax(u + 1,            x+1, y); }
+        if (x > 0)     { relax(u - 1,            x-1, y); }
+        if (y + 1 < h) { relax(u + std::uint32_t(C), x, y+1); }
+        if (y > 0)     { relax(u - std::uint32_t(C), x, y-1); }
+    }
+}
+
+void
+HierarchicalPathfinder::build(size_t k)
+{
+    Cluster& cl = clusters[k];
+    for (auto n : cl.nodes) { node_index[n] = NONE; }
+    cl.nodes.clear();
+    entrances(k, cl.nodes);
+    std::sort(cl.nodes.begin(), cl.nodes.end());
+    cl.nodes.erase(std::unique(cl.nodes.begin(), cl.nodes.end()),
+                   cl.nodes.end());
+
+    const size_t n = cl.nodes.size(), C = cluster_size;
+    for (size_t i = 0; i < n; ++i) { node_index[cl.nodes[i]] = std::uint32_t(i); }
+    cl.dist.assign(n * n, NONE);
+    std::vector<std::uint32_t> local;
+    for (size_t i = 0; i < n; ++i) {
+        flood(k, cl.nodes[i], local, nullptr);
+        for (size_t j = 0; j < n; ++j) {
+            const std::uint32_t c = cl.nodes[j];
+            cl.dist[i * n + j] = local[(c / width % C) * C + c % width % C];
+        }
+    }
+}
+
+void
+HierarchicalPathfinder::rebuild()
+{
+    for (size_t k = 0; k < clusters.size(); ++k) { build(k); }
+}
+
+void
+HierarchicalPathfinder::cellChanged(size_t x, size_t y)
+{
+    const size_t C = cluster_size;
+    const size_t kx = x / C, ky = y / C, k = ky * clusters_x + kx;
+    build(k);
+    // a border cell may open or close an entrance of the cluster next door
+    if (x % C == 0 && kx > 0)                                 { build(k - 1); }
+    if (x % C == C - 1 && kx + 1 < clusters_x)                { build(k + 1); }
+    if (y % C == 0 && ky > 0)                        { build(k - clusters_x); }
+    if (y % C == C - 1 && ky + 1 < clusters_y)       { build(k + clusters_x); }
+}
+
+bool
+HierarchicalPathfinder::findRoute(cell from, cell to, Route& route) const
+{
+    route = Route();
+    if (!maze.get().isPath(from.first, from.second) ||
+        !maze.get().isPath(to.first, to.second)) {
+        return false;
+    }
+
+    const size_t C = cluster_size;
+    const std::uint32_t start = std::uint32_t(from.second * width + from.first);
+    const std::uint32_t goal  = std::uint32_t(to.second * width + to.first);
+    const size_t ks = clusterOf(start), kg = clusterOf(goal);
+    auto local = [&](std::uint32_t c) {
+        return (c / width % C) * C + c % width % C;
+    };
+
+    Workspace& ws = workspace;
+    ws.begin(width * height);
+    flood(ks, start, ws.start_dist, nullptr);
+    flood(kg, goal,  ws.goal_dist,  nullptr);
+
+    auto h = [&](std::uint32_t c) {
+        return std::uint32_t(std::labs(long(c % width) - long(to.first)) +
+                             std::labs(long(c / width) - long(to.second)));
+    };
+    auto push = [&](std::uint32_t c, std::uint32_t g, std::uint32_t parent) {
+        if (ws.closed.contains(c)) { return; }
+        if (ws.seen.contains(c) && ws.g[c] <= g) { return; }
+        ws.seen.insert(c);
+        ws.g[c]      = g;
+        ws.parent[c] = parent;
+        ws.open.push_back(Node{ g + h(c), c });
+        std::push_heap(ws.open.begin(), ws.open.end());
+    };
+
+    push(start, 0, start);
+    bool found = false;
+    while (!ws.open.empty()) {
+        std::pop_heap(ws.open.begin(), ws.open.end());
+        const std::uint32_t c = ws.open.back().cell;
+        ws.open.pop_back();
+        if (ws.closed.contains(c)) { continue; }
+        ws.closed.insert(c);
+        if (c == goal) { found = true; break; }
+
+        const std::uint32_t g = ws.g[c];
+        const size_t k = clusterOf(c);
+        const Cluster& cl = clusters[k];
+        if (c == start) {
+            for (auto n : cl.nodes) {
+                std::uint32_t d = ws.start_dist[local(n)];
+                if (d != NONE) { push(n, g + d, c); }
+            }
+        }
+        const std::uint32_t i = node_index[c];
+        if (i != NONE) {
+            const size_t n = cl.nodes.size();
+            for (size_t j = 0; j < n; ++j) {
+                std::uint32_t d = cl.dist[i * n + j];
+                if (d != NONE && j != i) { push(cl.nodes[j], g + d, c); }
+            }
+            // across the border
+            const size_t x = c % width, y = c / width;
+            auto cross = [&](std::uint32_t v) {
+                if (node_index[v] != NONE && clusterOf(v) != k) {
+                    push(v, g + 1, c);
+                }
+            };
+            if (x + 1 < width)  { cross(c + 1); }
+            if (x > 0)          { cross(c - 1); }
+            if (y + 1 < height) { cross(c + std::uint32_t(width)); }
+            if (y > 0)          { cross(c - std::uint32_t(width)); }
+        }
+        if (k == kg) {
+            std::uint32_t d = ws.goal_dist[local(c)];
+            if (d != NONE) { push(goal, g + d, c); }
+        }
+    }
+    if (!found) { return false; }
+
+    for (std::uint32_t c = goal; ; c = ws.parent[c]) {
+        route.waypoints.push_back(cell(c % width, c / width));
+        if (c == start) { break; }
+    }
+    std::reverse(route.waypoints.begin(), route.waypoints.end());
+    route.length = long(ws.g[goal]);
+    return true;
+}
+
+size_t
+HierarchicalPathfinder::refine(Route& route, size_t legs,
+                               path_type& cells) const
+{
+    thread_local std::vector<std::uint32_t> dist, parent;
+    thread_local path_type leg;
+    const path_type& w = route.waypoints;
+    if (w.empty()) { return 0; }
+    if (route.next == 0) {
+        cells.push_back(w[0]);
+        route.next = 1;
+    }
+
+    const size_t C = cluster_size;
+    for (; legs > 0 && route.next < w.size(); --legs, ++route.next) {
+        const cell p = w[route.next - 1], q = w[route.next];
+        if (std::labs(long(p.first)  - long(q.first)) +
+            std::labs(long(p.second) - long(q.second)) == 1) {
+            cells.push_back(q);
+            continue;
+        }
+        // legs of more than one step never leave their cluster
+        const std::uint32_t pc = std::uint32_t(p.second * width + p.first);
+        const size_t k = clusterOf(pc);
+        const size_t x0 = k % clusters_x * C, y0 = k / clusters_x * C;
+        flood(k, pc, dist, &parent);
+        std::uint32_t s = std::uint32_t((p.second - y0) * C + (p.first - x0));
+        leg.clear();
+        for (std::uint32_t u = std::uint32_t((q.second - y0) * C + (q.first - x0));
+             u != s; u = parent[u]) {
+            leg.push_back(cell(x0 + u % C, y0 + u / C));
+        }
+        cells.insert(cells.end(), leg.rbegin(), leg.rend());
+    }
+    return w.size() - route.next;
+}
+
+bool
+HierarchicalPathfinder::findPath(cell from, cell to, path_type& path) const
+{
+    Route route;
+    path.clear();
+    if (!findRoute(from, to, route)) { return false; }
+    refine(route, route.waypoints.size(), path);
+    return true;
+}
+
+long
+HierarchicalPathfinder::distance(cell from, cell to) const
+{
+    Route route;
+    findRoute(from, to, route);
+    return route.length;
+}
+
+size_t
+HierarchicalPathfinder::nodeCount() const
+{
+    size_t n = 0;
+    for (auto& cl : clusters) { n += cl.nodes.size(); }
+    return n;
+}
+
+} // end namespace maps
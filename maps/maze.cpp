@@ -1,64 +1,334 @@
 
 #include "../misc/utility.hpp"
 #include "maze.hpp"
+#include "disjoint_sets.hpp"
+#include "neighborhood.hpp"
+#include "random_walls.hpp"
 
+#include <algorithm>
+#include <atomic>
+#include <thread>
 #include <type_traits>
 
 
 namespace maps {
 /** Initializes the borders and makes all other ground passable */
 void Maze::initialize_maze() {
-    for (size_t i = 1; i < width-1; ++i) {
-        for (size_t j = 1; j < height-1; ++j) {
-            setPath(i, j, PathTypes::NORMAL);
-        }
-    }
+    // a fresh grid is all PathTypes::NORMAL, so only the borders need setting
+    grid = BitGrid(width, height);
     /* fill borders */
     for (size_t i = 0; i < width; ++i) {
-        setWall(i, 0, WallTypes::BORDER);
+        setWall(i, 0,        WallTypes::BORDER);
+        setWall(i, height-1, WallTypes::BORDER);
     }
     for (size_t j = 0; j < height; ++j) {
-        setWall(0, j, WallTypes::BORDER);
+        setWall(0,       j, WallTypes::BORDER);
+        setWall(width-1, j, WallTypes::BORDER);
     }
 }
 
 /** makes the walls of the maze. */
 void Maze::make_walls() {
-    using std::make_pair;
+    random_walls(width, height, rng, density, complexity,
+                 [&](size_t x, size_t y) { return isPath(x, y); },
+                 [&](size_t x, size_t y) { setWall(x, y, WallTypes::INNER); });
+}
+
+namespace {
+const std::uint32_t NO_TREE = ~std::uint32_t(0);
+
+/**
+ * One tile of the tiled generator. Its pillars (the even,even cells walls
+ * grow from) are pillar_x0 + 2*i, pillar_y0 + 2*j for i < columns,
+ * j < rows.
+ */
+struct Tile {
+    size_t pillar_x0, pillar_y0;
+    size_t columns, rows;
+
+    // trees touching the tile edges, numbered 0 .. trees-1 within the tile
+    std::vector<std::uint32_t> left, right, top, bottom;
+    std::uint32_t trees;
+
+    Tile()
+        : pillar_x0(0), pillar_y0(0), columns(0), rows(0)
+        , left(), right(), top(), bottom(), trees(0)
+    {}
+};
+
+/** A wall that may join two trees across a tile seam. */
+struct SeamLink {
+    size_t x, y;
+    std::uint32_t a, b;
+};
+} // end anonymous namespace
+
+/**
+ * makes the walls of the maze in parallel.
+ *
+ * The grid is cut into TILE_SIZE square tiles and each tile runs the same
+ * random walks as make_walls(), confined to the tile and driven by its own
+ * stream split off rng. Tiles are word aligned, so threads never write the
+ * same word of the grid, and the result depends only on the seed.
+ *
+ * Walls that never touch the border can't enclose anything, so after the
+ * walks every path cell is still connected. The walks can't cross tile
+ * seams, though, which would leave a straight open corridor along each
+ * seam; the stitching pass closes some of those links, but only between
+ * different wall trees, so the walls stay a forest and the maze stays
+ * connected.
+ */
+void Maze::make_walls_tiled() {
     using utility::rand;
 
-    size_t complexity = size_t(this->complexity*(5*(width + height)));
-    size_t density    = size_t(this->density*width/2*height/2);
-
-    for (size_t i = 0; i < density; ++i) {
-        size_t x = rand(0, width/2)*2;
-        size_t y = rand(0, height/2)*2;
-        setWall(x, y, WallTypes::INNER);
-
-        std::vector<std::pair<size_t, size_t>> neigh;
-        neigh.reserve(4);
-        for (size_t j = 0; j < complexity; ++j) {
-            // add all neighbors that are not out of bounds
-            if (x > 1)        { neigh.push_back( make_pair(x-2, y) ); }
-            if (x < height-2) { neigh.push_back( make_pair(x+2, y) ); }
-            if (y > 1)        { neigh.push_back( make_pair(x, y-2) ); }
-            if (y < width-2)  { neigh.push_back( make_pair(x, y+2) ); }
-            if (neigh.size()) { // choose a random neighbor if there are any
-                auto n = neigh[rand(0, neigh.size())];
-                if (isPath(n.first, n.second)) {
-                    auto link = make_pair(
-                            x + static_cast<long long>(n.first - x)/2,
-                            y + static_cast<long long>(n.second - y)/2);
-                    setWall(n.first,    n.second,    WallTypes::INNER);
-                    setWall(link.first, link.second, WallTypes::INNER);
-                    x = n.first;
-                    y = n.second;
+    const size_t tiles_x = (width  + TILE_SIZE - 1) / TILE_SIZE;
+    const size_t tiles_y = (height + TILE_SIZE - 1) / TILE_SIZE;
+
+    std::vector<Tile> tiles(tiles_x * tiles_y);
+    std::vector<utility::generator> streams;
+    streams.reserve(tiles.size());
+    for (size_t t = 0; t < tiles.size(); ++t) {
+        streams.push_back(rng.split());
+    }
+
+    const double density    = this->density;
+    const double complexity = this->complexity;
+
+    // straight to the grid - setWall() bumps revision, which isn't atomic
+    const auto inner = static_cast<unsigned int>(WallTypes::INNER);
+    auto wall = [&](size_t x, size_t y) { grid.set(x, y, true, inner); };
+
+    auto walk_tile = [&](size_t t) {
+        Tile& tile = tiles[t];
+        utility::generator& g = streams[t];
+
+        // pillars strictly inside the border, so no tree touches it
+        size_t x0 = std::max<size_t>((t % tiles_x) * TILE_SIZE, 2);
+        size_t y0 = std::max<size_t>((t / tiles_x) * TILE_SIZE, 2);
+        size_t x1 = std::min((t % tiles_x + 1) * TILE_SIZE, width - 1);
+        size_t y1 = std::min((t / tiles_x + 1) * TILE_SIZE, height - 1);
+        tile.pillar_x0 = x0;
+        tile.pillar_y0 = y0;
+        tile.columns   = x1 > x0 ? (x1 - x0 + 1) / 2 : 0;
+        tile.rows      = y1 > y0 ? (y1 - y0 + 1) / 2 : 0;
+        tile.trees     = 0;
+        const size_t cols = tile.columns, rows = tile.rows;
+        if (!cols || !rows) { return; }
+
+        size_t walks = size_t(density * cols * rows);
+        size_t steps = size_t(complexity * 5 * (2 * cols + 2 * rows));
+
+        size_t neigh[4];
+        for (size_t i = 0; i < walks; ++i) {
+            size_t px = rand(g, 0, cols);
+            size_t py = rand(g, 0, rows);
+            wall(x0 + 2*px, y0 + 2*py);
+
+            for (size_t j = 0; j < steps; ++j) {
+                size_t n = 0, free = 0;
+                // neighbors as px, py packed into one number
+                if (px > 0)      { neigh[n++] = (px-1) * rows + py; }
+                if (px+1 < cols) { neigh[n++] = (px+1) * rows + py; }
+                if (py > 0)      { neigh[n++] = px * rows + py-1; }
+                if (py+1 < rows) { neigh[n++] = px * rows + py+1; }
+                for (size_t k = 0; k < n; ++k) {
+                    size_t nx = x0 + 2*(neigh[k] / rows);
+                    size_t ny = y0 + 2*(neigh[k] % rows);
+                    free += isPath(nx, ny);
+                }
+                if (!free) { break; } // walls never turn back into paths
+                size_t c = neigh[rand(g, 0, n)];
+                size_t nx = c / rows, ny = c % rows;
+                if (isPath(x0 + 2*nx, y0 + 2*ny)) {
+                    wall(x0 + 2*nx, y0 + 2*ny);
+                    wall(x0 + px + nx, y0 + py + ny);
+                    px = nx;
+                    py = ny;
                 }
             }
-            neigh.clear();
         }
+
+        // label the wall trees, keeping only the labels on the tile edges
+        std::vector<std::uint32_t> label(cols * rows, NO_TREE);
+        std::vector<size_t> stack;
+        std::uint32_t trees = 0;
+        for (size_t p = 0; p < cols * rows; ++p) {
+            size_t px = p / rows, py = p % rows;
+            if (label[p] != NO_TREE || isPath(x0 + 2*px, y0 + 2*py)) {
+                continue;
+            }
+            label[p] = trees;
+            stack.push_back(p);
+            while (!stack.empty()) {
+                size_t q = stack.back();
+                stack.pop_back();
+                size_t qx = q / rows, qy = q % rows;
+                size_t x = x0 + 2*qx, y = y0 + 2*qy;
+                auto visit = [&](size_t r, size_t lx, size_t ly) {
+                    if (label[r] == NO_TREE && isWall(lx, ly)) {
+                        label[r] = trees;
+                        stack.push_back(r);
+                    }
+                };
+                if (qx > 0)      { visit(q - rows, x-1, y); }
+                if (qx+1 < cols) { visit(q + rows, x+1, y); }
+                if (qy > 0)      { visit(q - 1,    x, y-1); }
+                if (qy+1 < rows) { visit(q + 1,    x, y+1); }
+            }
+            ++trees;
+        }
+
+        // renumber so that only trees reaching an edge get an id
+        std::vector<std::uint32_t> renumber(trees, NO_TREE);
+        auto edge = [&](size_t px, size_t py) {
+            std::uint32_t& l = label[px * rows + py];
+            if (l == NO_TREE) { return NO_TREE; }
+            if (renumber[l] == NO_TREE) { renumber[l] = tile.trees++; }
+            return renumber[l];
+        };
+        for (size_t py = 0; py < rows; ++py) {
+            tile.left.push_back(edge(0, py));
+            tile.right.push_back(edge(cols-1, py));
+        }
+        for (size_t px = 0; px < cols; ++px) {
+            tile.top.push_back(edge(px, 0));
+            tile.bottom.push_back(edge(px, rows-1));
+        }
+    };
+
+    std::atomic<size_t> next(0);
+    auto worker = [&]() {
+        for (size_t t = next++; t < tiles.size(); t = next++) {
+            walk_tile(t);
+        }
+    };
+    std::vector<std::thread> pool;
+    for (unsigned int i = 1; i < threads; ++i) {
+        pool.emplace_back(worker);
     }
+    worker();
+    for (auto& th : pool) { th.join(); }
 
+    /* stitch the seams */
+    std::vector<std::uint32_t> offset(tiles.size() + 1, 0);
+    for (size_t t = 0; t < tiles.size(); ++t) {
+        offset[t+1] = offset[t] + tiles[t].trees;
+    }
+    std::vector<SeamLink> links;
+    auto candidate = [&](size_t x, size_t y, size_t ta, std::uint32_t a,
+                                             size_t tb, std::uint32_t b) {
+        if (a != NO_TREE && b != NO_TREE) {
+            links.push_back(SeamLink{x, y, offset[ta] + a, offset[tb] + b});
+        }
+    };
+    for (size_t t = 0; t < tiles.size(); ++t) {
+        const Tile& a = tiles[t];
+        if (!a.columns || !a.rows) { continue; }
+        if (t % tiles_x + 1 < tiles_x && tiles[t+1].columns) {
+            const Tile& b = tiles[t+1];
+            for (size_t py = 0; py < a.rows; ++py) {
+                candidate(b.pillar_x0 - 1, a.pillar_y0 + 2*py,
+                          t, a.right[py], t+1, b.left[py]);
+            }
+        }
+        if (t / tiles_x + 1 < tiles_y && tiles[t+tiles_x].rows) {
+            const Tile& b = tiles[t+tiles_x];
+            for (size_t px = 0; px < a.columns; ++px) {
+                candidate(a.pillar_x0 + 2*px, b.pillar_y0 - 1,
+                          t, a.bottom[px], t+tiles_x, b.top[px]);
+            }
+        }
+    }
+
+    utility::random_shuffle(rng, links);
+    DisjointSets trees(offset.back());
+    for (auto& l : links) {
+        // about half, like the links the walks lay elsewhere
+        if (rng() & 1 && trees.unite(l.a, l.b)) {
+            setWall(l.x, l.y, WallTypes::INNER);
+        }
+    }
+}
+
+/*
+ * The loop body has no branches: positions outside the maze are clamped to
+ * cell (0, 0) and masked out afterwards, so the compiler can vectorize the
+ * conversions and bounds tests and only the word loads stay scalar.
+ */
+void Maze::isPathBatch(const double* xs, const double* ys, size_t n,
+                       std::uint64_t* mask) const {
+    const BitGrid::word_type* walls = grid.wallData();
+    const size_t words_per_row = grid.getWordsPerRow();
+    const double w = double(width), h = double(height);
+    if (width == 0 || height == 0) {
+        std::fill(mask, mask + (n + 63) / 64, 0);
+        return;
+    }
+
+    for (size_t base = 0; base < n; base += 64) {
+        const size_t count = std::min<size_t>(64, n - base);
+        std::uint64_t bits = 0;
+        for (size_t i = 0; i < count; ++i) {
+            const double x = xs[base + i], y = ys[base + i];
+            // false for NaN too
+            const bool inside = x >= 0 && y >= 0 && x < w && y < h;
+            const size_t cx = inside ? size_t(x) : 0;
+            const size_t cy = inside ? size_t(y) : 0;
+            const std::uint64_t wall =
+                walls[cy * words_per_row + cx / 64] >> (cx % 64);
+            bits |= std::uint64_t(inside & !(wall & 1)) << i;
+        }
+        mask[base / 64] = bits;
+    }
+}
+
+void Maze::edit(size_t x, size_t y, bool wall, unsigned int subtype) {
+    assert(x < width);
+    assert(y < height);
+    const std::uint8_t before = std::uint8_t(
+            (grid.isWall(x, y) ? 1 : 0) | grid.getSubtype(x, y) << 1);
+    const std::uint8_t after = std::uint8_t((wall ? 1 : 0) | subtype << 1);
+    if (before == after) { return; }
+
+    grid.set(x, y, wall, subtype);
+    ++revision;
+    journal.push_back(CellChange{
+            std::uint32_t(x), std::uint32_t(y), before, after });
+
+    // grow a rectangle that touches the cell, or start a new one
+    for (auto& r : dirty) {
+        if (x + 1 >= r.x0 && x <= r.x1 && y + 1 >= r.y0 && y <= r.y1) {
+            r.x0 = std::min(r.x0, x);
+            r.y0 = std::min(r.y0, y);
+            r.x1 = std::max(r.x1, x + 1);
+            r.y1 = std::max(r.y1, y + 1);
+            return;
+        }
+    }
+    dirty.push_back(DirtyRect{ x, y, x + 1, y + 1 });
+    if (dirty.size() > MAX_DIRTY_RECTS) {
+        DirtyRect all = dirty.front();
+        for (auto& r : dirty) {
+            all.x0 = std::min(all.x0, r.x0);
+            all.y0 = std::min(all.y0, r.y0);
+            all.x1 = std::max(all.x1, r.x1);
+            all.y1 = std::max(all.y1, r.y1);
+        }
+        dirty.assign(1, all);
+    }
+}
+
+void Maze::buildWall(size_t x, size_t y, WallTypes t) {
+    edit(x, y, true, static_cast<unsigned int>(t));
+}
+
+void Maze::destroyWall(size_t x, size_t y, PathTypes t) {
+    edit(x, y, false, static_cast<unsigned int>(t));
+}
+
+void Maze::clearChanges() {
+    journal.clear();
+    dirty.clear();
 }
 
 /**
@@ -83,32 +353,9 @@ Maze::find_blind_ends() {
     using std::pair;
 
     std::vector<pair<pair<size_t, size_t>, pair<int, int>>> koti;
-    std::vector<pair<size_t, size_t>> neighbors
-        {
-            make_pair(-1,1),  make_pair(0,1),  make_pair(1,1),
-            make_pair(-1,0),                   make_pair(1,0),
-            make_pair(-1,-1), make_pair(0,-1), make_pair(1,-1)
-        };
-
-    for (size_t row = 1; row < height-1; ++row) {
-        for (size_t col = 1; col < width-1; ++col) {
-            if (isWall(col, row)) { continue; }
-
-            auto monster = make_pair(0,0);
-            size_t kot = 0;
-            for (auto n : neighbors) {
-                auto x = col + n.first;
-                auto y = row + n.second;
-                if (isWall(x, y)) {
-                    kot += 1;
-                } else {
-                    monster = n;
-                }
-            }
-            if (kot == 7) {
-                koti.push_back(make_pair(make_pair(col, row),monster));
-            }
-        }
+    Neighborhood around(grid);
+    for (auto& c : around.blindEnds()) {
+        koti.push_back(make_pair(c, around.exitOf(c.first, c.second)));
     }
     return koti;
 }
@@ -117,7 +364,7 @@ void Maze::place_treasure_with_guardian_monsters() {
     using std::make_pair;
     using utility::random_shuffle;
     auto koti = find_blind_ends();
-    random_shuffle(koti);
+    random_shuffle(rng, koti);
 
     size_t how_many_monsters = 10;
     treasure.reserve(how_many_monsters);
@@ -150,8 +397,8 @@ void Maze::place_wondering_monsters()
     using utility::rand;
     /* wondering monsters */
     for (size_t i = 1; i < 40; i++) {
-        size_t w = rand(1, width-1);
-        size_t h = rand(1, height-1);
+        size_t w = rand(rng, 1, width-1);
+        size_t h = rand(rng, 1, height-1);
         if (isPath(w, h)) {
             monsters.push_back(
                     Object{
@@ -177,34 +424,85 @@ std::pair<size_t, size_t> Maze::quadrant(size_t x, size_t y) {
     auto col_half = (height-1)/2;
     return make_pair(x/row_half, y/col_half);
 }
+namespace {
+/** the inner cells of a width x height maze that pass test, row by row */
+template <typename Test>
+std::vector<std::pair<size_t, size_t>>
+candidates(size_t width, size_t height, Test test) {
+    std::vector<std::pair<size_t, size_t>> cells;
+    for (size_t y = 1; y + 1 < height; ++y) {
+        for (size_t x = 1; x + 1 < width; ++x) {
+            if (test(x, y)) { cells.push_back(std::make_pair(x, y)); }
+        }
+    }
+    return cells;
+}
+} // end anonymous namespace
+
+/*
+ * Start and finish are drawn from lists of the cells that qualify rather
+ * than by retrying random cells, so placement takes the same time whatever
+ * the shape of the maze. When nothing qualifies the rules are relaxed
+ * instead of looping forever.
+ */
 void Maze::place_start()
 {
-    using std::make_pair;
-    using utility::rand;
-    do { // try to get a good start position
-        start = make_pair(rand(1,width-1), rand(1, height-1));
-        // and repeat if we failed and the found coordinates are in the
-        // center third
-    } while (!(
-                !is_in_center_third(start.first, start.second) &&
-                isPath(start.first, start.second)));
+    using utility::random_pick;
+    auto cells = candidates(width, height, [&](size_t x, size_t y) {
+        return isPath(x, y) && !is_in_center_third(x, y);
+    });
+    if (cells.empty()) {
+        cells = candidates(width, height, [&](size_t x, size_t y) {
+            return isPath(x, y);
+        });
+    }
+    start = cells.empty() ? std::pair<size_t, size_t>(1, 1)
+                          : random_pick(rng, cells);
 }
 
 void Maze::place_end() {
-    // make sure start has been set
-    assert(start.first != 0 && start.second != 0);
+    using utility::random_pick;
+    if (!isPath(start.first, start.second)) { // a maze without paths
+        finish = start;
+        return;
+    }
 
-    using std::make_pair;
-    using utility::rand;
+    // the finish has to be reachable from the start
+    std::vector<bool> reachable(width * height, false);
+    std::vector<std::pair<size_t, size_t>> queue(1, start);
+    reachable[start.second * width + start.first] = true;
+    for (size_t head = 0; head < queue.size(); ++head) {
+        const size_t x = queue[head].first, y = queue[head].second;
+        const size_t next[4][2] = {
+            { x + 1, y }, { x - 1, y }, { x, y + 1 }, { x, y - 1 }
+        };
+        for (auto& n : next) {
+            if (n[0] >= width || n[1] >= height) { continue; }
+            if (reachable[n[1] * width + n[0]] || !isPath(n[0], n[1])) {
+                continue;
+            }
+            reachable[n[1] * width + n[0]] = true;
+            queue.push_back(std::make_pair(n[0], n[1]));
+        }
+    }
 
     auto start_quadrant = quadrant(start.first, start.second);
-
-    do {
-        finish = make_pair(rand(1, width-1), rand(1, height-1));
-    } while (!(
-                !is_in_center_third(finish.first, finish.second) &&
-                start_quadrant != quadrant(finish.first, finish.second)
-              ));
+    auto away = [&](size_t x, size_t y) {
+        return reachable[y * width + x] && std::make_pair(x, y) != start;
+    };
+    auto cells = candidates(width, height, [&](size_t x, size_t y) {
+        return away(x, y) && !is_in_center_third(x, y) &&
+               quadrant(x, y) != start_quadrant;
+    });
+    if (cells.empty()) {
+        cells = candidates(width, height, [&](size_t x, size_t y) {
+            return away(x, y) && !is_in_center_third(x, y);
+        });
+    }
+    if (cells.empty()) {
+        cells = candidates(width, height, away);
+    }
+    finish = cells.empty() ? start : random_pick(rng, cells);
 }
 
 } //end namespace maps
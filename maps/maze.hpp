@@ -8,8 +8,15 @@
  * @since 2012-05-01
  */
 
-#include <boost/multi_array.hpp>
+#include "bitgrid.hpp"
+#include "object_index.hpp"
+#include "../misc/random.hpp"
+
+#include <cassert>
+#include <cstdint>
+#include <type_traits>
 #include <utility>
+#include <vector>
 
 namespace maps {
 
@@ -23,47 +30,69 @@ enum class PathTypes : unsigned int {
     GRASSY
 };
 
-enum class ObjectType {
-    TREASURE,
-    MONSTER,
-    START,
-    END
+/**
+ * One runtime edit of a cell. A cell's state is packed in a byte: bit 0 is
+ * set for walls, the bits above hold the wall or path type.
+ */
+struct CellChange {
+    std::uint32_t x;
+    std::uint32_t y;
+    std::uint8_t before;
+    std::uint8_t after;
+
+    bool wasWall() const { return before & 1; }
+    bool isWall()  const { return after & 1; }
 };
 
-struct Object {
-    std::pair<size_t, size_t> position;
-    ObjectType type;
-    // difficulty for monsters (higer - more difficult)
-    // type for treasures (maybe upgrade goo?)
-    unsigned int value;
+/** The cells [x0, x1) x [y0, y1). */
+struct DirtyRect {
+    size_t x0, y0;
+    size_t x1, y1;
 };
 
 class Maze {
     private:
     enum class FieldTypes : unsigned int {
-        TYPE_MASK = 0xff000000,
-        PATH = 0x01000000,
-        WALL = 0x02000000,
+        PATH,
+        WALL
     };
 
-    typedef boost::multi_array<FieldTypes, 2> maze_type;
-
     size_t width;
     size_t height;
 
     double difficulty;
+    std::uint64_t seed;
 
     double density;
     double complexity;
 
-    decltype(boost::extents[width][height]) shape;
-    maze_type maze;
+    /** 0 for the serial generator, otherwise threads of the tiled one */
+    unsigned int threads;
+    /** side of a tile of the tiled generator; a multiple of 64 */
+    static const size_t TILE_SIZE = 256;
+
+    BitGrid grid;
+    /** drives every random decision of the generator, seeded with seed */
+    utility::generator rng;
 
     std::vector<Object> monsters;
     std::vector<Object> treasure;
+    /** the monsters and the treasure, bucketed by position */
+    ObjectIndex objects;
     std::pair<size_t, size_t> start;
     std::pair<size_t, size_t> finish;
 
+    /** bumped on every cell change, so caches can tell they are stale */
+    std::uint64_t revision;
+
+    /** the runtime edits since the last clearChanges() */
+    std::vector<CellChange> journal;
+    std::vector<DirtyRect> dirty;
+    /** more dirty rectangles than this are merged into their bounds */
+    static const size_t MAX_DIRTY_RECTS = 32;
+
+    void edit(size_t x, size_t y, bool wall, unsigned int subtype);
+
     std::vector<std::pair<std::pair<size_t, size_t>, std::pair<int, int>>>
     find_blind_ends();
     bool is_in_center_third(size_t x, size_t y);
@@ -71,6 +100,7 @@ class Maze {
 
     void initialize_maze();
     void make_walls();
+    void make_walls_tiled();
     void place_treasure_with_guardian_monsters();
     void place_wondering_monsters();
     void place_start();
@@ -80,11 +110,31 @@ class Maze {
     generate_maze()
     {
         initialize_maze();
-        make_walls();
+        if (threads) {
+            make_walls_tiled();
+        } else {
+            make_walls();
+        }
+        populate();
+    }
+
+    /** places the objects into an already walled maze */
+    inline void
+    populate()
+    {
         place_treasure_with_guardian_monsters();
         place_wondering_monsters();
         place_start();
         place_end();
+        index_objects();
+    }
+
+    inline void
+    index_objects()
+    {
+        objects = ObjectIndex(width, height);
+        for (auto& m : monsters) { objects.insert(m); }
+        for (auto& t : treasure) { objects.insert(t); }
     }
 
     inline void
@@ -92,11 +142,9 @@ class Maze {
 //        std::cerr << "x: " << x << " y: " << y << std::endl;
         assert(x < width);
         assert(y < height);
-        using ult = std::underlying_type<FieldTypes>::type;
-        maze[x][y] = static_cast<FieldTypes>(
-                static_cast<ult>(t) |
-                static_cast<ult>(FieldTypes::PATH)
-                );
+        using ult = std::underlying_type<PathTypes>::type;
+        grid.set(x, y, false, static_cast<ult>(t));
+        ++revision;
     }
 
     inline void
@@ -104,39 +152,107 @@ class Maze {
 //        std::cerr << "x: " << x << " y: " << y << std::endl;
         assert(x < width);
         assert(y < height);
-        using ult = std::underlying_type<FieldTypes>::type;
-        maze[x][y] = static_cast<FieldTypes>(
-                static_cast<ult>(t) |
-                static_cast<ult>(FieldTypes::WALL)
-                );
+        using ult = std::underlying_type<WallTypes>::type;
+        grid.set(x, y, true, static_cast<ult>(t));
+        ++revision;
     }
 
     inline FieldTypes
     getType(size_t x, size_t y) const {
         assert(x < width);
         assert(y < height);
-        return
-            static_cast<FieldTypes>(
-                static_cast<unsigned int>(maze[x][y]) &
-                static_cast<unsigned int>(FieldTypes::TYPE_MASK));
+        return grid.isWall(x, y) ? FieldTypes::WALL : FieldTypes::PATH;
     }
 
     public:
 
-    Maze(size_t width, size_t height, double difficulty)
+    /**
+     * Generates a maze. The same seed always produces the same maze.
+     *
+     * @param threads 0 runs the classic serial generator. Any other value
+     * runs the tiled generator on that many threads; its output depends
+     * only on the seed, not on the number of threads.
+     * @param density how many walls are grown, relative to the pillars
+     * @param complexity how long each wall grows, relative to the size
+     */
+    Maze(size_t width, size_t height, double difficulty,
+         std::uint64_t seed = utility::generator::DEFAULT_SEED,
+         unsigned int threads = 0,
+         double density = 0.75, double complexity = 0.75)
         : width( (width/2)  * 2 + 1)
         , height((height/2) * 2 + 1)
         , difficulty(difficulty)
+        , seed(seed)
+        , density(density)
+        , complexity(complexity)
+        , threads(threads)
+        , grid(this->width, this->height)
+        , rng(seed)
+        , monsters()
+        , treasure()
+        , objects()
+        , start(0,0)
+        , finish(0,0)
+        , revision(0)
+        , journal()
+        , dirty()
+    {
+        generate_maze();
+    }
+
+    /**
+     * Makes a maze out of an already generated grid, such as one collected
+     * from an EllerGenerator, and places the objects into it.
+     */
+    Maze(BitGrid grid, double difficulty,
+         std::uint64_t seed = utility::generator::DEFAULT_SEED)
+        : width(grid.getWidth())
+        , height(grid.getHeight())
+        , difficulty(difficulty)
+        , seed(seed)
         , density(0.75)
         , complexity(0.75)
-        , shape(boost::extents[width][height])
-        , maze(shape)
+        , threads(0)
+        , grid(std::move(grid))
+        , rng(seed)
         , monsters()
         , treasure()
+        , objects()
         , start(0,0)
         , finish(0,0)
+        , revision(0)
+        , journal()
+        , dirty()
     {
-        generate_maze();
+        populate();
+    }
+
+    /**
+     * Reassembles a maze from its parts exactly as they were, without
+     * generating or placing anything - used when loading mazes from files.
+     */
+    Maze(BitGrid grid, double difficulty, std::uint64_t seed,
+         std::vector<Object> monsters, std::vector<Object> treasure,
+         std::pair<size_t, size_t> start, std::pair<size_t, size_t> finish)
+        : width(grid.getWidth())
+        , height(grid.getHeight())
+        , difficulty(difficulty)
+        , seed(seed)
+        , density(0.75)
+        , complexity(0.75)
+        , threads(0)
+        , grid(std::move(grid))
+        , rng(seed)
+        , monsters(std::move(monsters))
+        , treasure(std::move(treasure))
+        , objects()
+        , start(start)
+        , finish(finish)
+        , revision(0)
+        , journal()
+        , dirty()
+    {
+        index_objects();
     }
 
     inline bool
@@ -153,33 +269,102 @@ class Maze {
         return getType(x, y) == FieldTypes::PATH;
     }
 
+    /**
+     * isPath() for n positions at once, for moving many actors per tick.
+     *
+     * Position i is (xs[i], ys[i]) in maze units; like isPath() the cell is
+     * found by truncating the coordinates. Bit i % 64 of mask[i / 64] is set
+     * if the position is on a path; positions outside the maze are blocked
+     * rather than asserted. mask needs room for (n + 63) / 64 words.
+     */
+    void isPathBatch(const double* xs, const double* ys, size_t n,
+                     std::uint64_t* mask) const;
+
     inline WallTypes
     getWallType(size_t x, size_t y) const {
         assert(x < width);
         assert(y < height);
         assert(getType(x, y) == FieldTypes::WALL);
-        using ult = std::underlying_type<FieldTypes>::type;
-        return static_cast<WallTypes>(
-                    static_cast<ult>(maze[x][y]) &
-                    ~static_cast<ult>(FieldTypes::TYPE_MASK)
-                );
+        return static_cast<WallTypes>(grid.getSubtype(x, y));
     }
 
     inline PathTypes
     getPathType(size_t x, size_t y) const {
         assert(x < width);
         assert(y < height);
-        assert(getType(x, y) == FieldTypes::WALL);
-        using ult = std::underlying_type<FieldTypes>::type;
-        return static_cast<PathTypes>(
-                    static_cast<ult>(maze[x][y]) &
-                    ~static_cast<ult>(FieldTypes::TYPE_MASK)
-                );
+        assert(getType(x, y) == FieldTypes::PATH);
+        return static_cast<PathTypes>(grid.getSubtype(x, y));
+    }
+
+    /**
+     * Wall bits of row y, packed 64 cells to a word (bit i of word k is
+     * the cell at x = 64*k + i). See BitGrid for the layout.
+     */
+    inline const BitGrid::word_type*
+    wallRow(size_t y) const {
+        assert(y < height);
+        return grid.wallRow(y);
     }
 
+    /**
+     * Wall bits of the 64 cells (x, y) .. (x+63, y), bit i being cell x+i.
+     * Cells outside the maze read as walls, so x-1 and y-1 are fine to ask
+     * for when testing neighbors.
+     */
+    inline BitGrid::word_type
+    wallWord(std::ptrdiff_t x, std::ptrdiff_t y) const {
+        return grid.wallWord(x, y);
+    }
+
+    /** Path bits of the 64 cells starting at (x, y); see wallWord. */
+    inline BitGrid::word_type
+    pathWord(std::ptrdiff_t x, std::ptrdiff_t y) const {
+        return grid.pathWord(x, y);
+    }
+
+    const BitGrid& getGrid() const { return grid; }
+
+    /**
+     * Runtime edits. Unlike the generator's writes these are recorded: the
+     * journal lists every change with the cell's state before and after,
+     * and the dirty rectangles cover the cells changed. Both accumulate
+     * until clearChanges(), usually once per tick after everyone that
+     * follows the maze (the renderer, cellChanged() of the path and
+     * distance structures) has caught up. Edits that change nothing are
+     * not recorded.
+     */
+    void buildWall(size_t x, size_t y, WallTypes t = WallTypes::INNER);
+    void destroyWall(size_t x, size_t y, PathTypes t = PathTypes::NORMAL);
+
+    const std::vector<CellChange>& getJournal() const { return journal; }
+
+    /**
+     * Rectangles covering every cell changed since clearChanges(). They
+     * may overlap; there are never more than a few dozen.
+     */
+    const std::vector<DirtyRect>& getDirtyRects() const { return dirty; }
+
+    void clearChanges();
+
     decltype(width)  getWidth()  const { return width; }
     decltype(height) getHeight() const { return height; }
 
+    decltype(seed) getSeed() const { return seed; }
+    decltype(revision) getRevision() const { return revision; }
+    decltype(difficulty) getDifficulty() const { return difficulty; }
+
+    /** the objects as they were placed */
+    const std::vector<Object>& getMonsters() const { return monsters; }
+    const std::vector<Object>& getTreasure() const { return treasure; }
+
+    /**
+     * The monsters and the treasure for proximity queries. The index is
+     * the live state: move, take and add objects through it, the lists
+     * above stay as placed.
+     */
+    const ObjectIndex& getObjects() const { return objects; }
+    ObjectIndex& getObjects() { return objects; }
+
     decltype(start) getStart() const { return start; }
     decltype(finish) getFinish() const { return finish; }
 };
@@ -0,0 +1,170 @@
+/**
+ * @file maze_cache.cpp
+ * Generated mazes shared by their generation parameters.
+ *
+ * @since 2026-10-17
+ */
+
+#include "maze_cache.hpp"
+#include "maze_file.hpp"
+#include "exceptions.hpp"
+
+#include <algorithm>
+#include <fstream>
+#include <functional>
+#include <iomanip>
+#include <sstream>
+
+namespace maps {
+
+namespace {
+inline void
+hash_combine(size_t& h, size_t v)
+{
+    h ^= v + 0x9e3779b97f4a7c15ULL + (h << 6) + (h >> 2);
+}
+} // end anonymous namespace
+
+size_t
+MazeKeyHash::operator()(const MazeKey& key) const
+{
+    size_t h = std::hash<size_t>()(key.width);
+    hash_combine(h, std::hash<size_t>()(key.height));
+    hash_combine(h, std::hash<double>()(key.difficulty));
+    hash_combine(h, std::hash<double>()(key.density));
+    hash_combine(h, std::hash<double>()(key.complexity));
+    hash_combine(h, std::hash<std::uint64_t>()(key.seed));
+    return h;
+}
+
+MazeCache::MazeCache(const std::string& directory, unsigned int threads,
+                     size_t capacity)
+    : directory(directory)
+    , threads(threads)
+    , capacity(std::max<size_t>(capacity, 1))
+    , mutex()
+    , entries()
+    , lru()
+    , hits(0)
+    , misses(0)
+{}
+
+std::string
+MazeCache::fileName(const MazeKey& key) const
+{
+    // 17 digits print every double exactly
+    std::ostringstream name;
+    name << std::setprecision(17)
+         << key.width << "x" << key.height
+         << "-d" << key.difficulty
+         << "-n" << key.density
+         << "-c" << key.complexity
+         << "-s" << key.seed
+         << (threads ? "-tiled" : "-serial") << ".hxmz";
+    return name.str();
+}
+
+MazeCache::maze_ptr
+MazeCache::make(const MazeKey& key) const
+{
+    const std::string path =
+        directory.empty() ? "" : directory + "/" + fileName(key);
+
+    if (!path.empty() && std::ifstream(path.c_str()).good()) {
+        try {
+            maze_ptr maze = std::make_shared<const Maze>(load_maze(path));
+            if (maze->getWidth() == key.width &&
+                maze->getHeight() == key.height &&
+                maze->getSeed() == key.seed &&
+                maze->getDifficulty() == key.difficulty) {
+                return maze;
+            }
+        } catch (const err::bad_format&) {
+            // written again below
+        }
+    }
+
+    maze_ptr maze = std::make_shared<const Maze>(
+        key.width, key.height, key.difficulty, key.seed, threads,
+        key.density, key.complexity);
+    if (!path.empty()) {
+        save_maze(*maze, path); // renames into place, readers see no halves
+    }
+    return maze;
+}
+
+MazeCache::maze_ptr
+MazeCache::get(const MazeKey& key)
+{
+    std::promise<maze_ptr> promise;
+    std::shared_future<maze_ptr> shared;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        auto it = entries.find(key);
+        if (it != entries.end()) {
+            ++hits;
+            lru.splice(lru.begin(), lru, it->second.used);
+            shared = it->second.maze;
+        } else {
+            ++misses;
+            lru.push_front(key);
+            entries.insert(std::make_pair(
+                key, Entry{ promise.get_future().share(), lru.begin() }));
+            while (entries.size() > capacity) {
+                entries.erase(lru.back());
+                lru.pop_back();
+            }
+        }
+    }
+    if (shared.valid()) { // someone else made it, or is making it
+        return shared.get();
+    }
+
+    try {
+        maze_ptr maze = make(key);
+        promise.set_value(maze);
+        return maze;
+    } catch (...) {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            auto it = entries.find(key);
+            if (it != entries.end()) {
+                lru.erase(it->second.used);
+                entries.erase(it);
+            }
+        }
+        promise.set_exception(std::current_exception());
+        throw;
+    }
+}
+
+size_t
+MazeCache::size() const
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    return entries.size();
+}
+
+void
+MazeCache::clear()
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    entries.clear();
+    lru.clear();
+}
+
+size_t
+MazeCache::getHits() const
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    return hits;
+}
+
+size_t
+MazeCache::getMisses() const
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    return misses;
+}
+
+} // end namespace maps
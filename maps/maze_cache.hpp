@@ -0,0 +1,118 @@
+#ifndef MAZE_CACHE_HPP_GUARD
+#define MAZE_CACHE_HPP_GUARD
+/**
+ * @file maze_cache.hpp
+ * Generated mazes shared by their generation parameters.
+ *
+ * @since 2026-10-17
+ */
+
+#include "maze.hpp"
+
+#include <cstdint>
+#include <future>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+
+namespace maps {
+
+/** Everything that decides what a generated maze looks like. */
+struct MazeKey {
+    size_t width;
+    size_t height;
+    double difficulty;
+    double density;
+    double complexity;
+    std::uint64_t seed;
+
+    MazeKey(size_t width, size_t height, double difficulty,
+            std::uint64_t seed = utility::generator::DEFAULT_SEED,
+            double density = 0.75, double complexity = 0.75)
+        : width( (width/2)  * 2 + 1) // as Maze rounds them
+        , height((height/2) * 2 + 1)
+        , difficulty(difficulty)
+        , density(density)
+        , complexity(complexity)
+        , seed(seed)
+    {}
+
+    bool
+    operator==(const MazeKey& o) const {
+        return width == o.width && height == o.height &&
+               difficulty == o.difficulty && density == o.density &&
+               complexity == o.complexity && seed == o.seed;
+    }
+};
+
+struct MazeKeyHash {
+    size_t operator()(const MazeKey& key) const;
+};
+
+/**
+ * Hands out generated mazes by key, generating each only once. The mazes
+ * are shared read-only; copy one to edit it.
+ *
+ * With a directory the mazes are also kept there as maze files (see
+ * maze_file.hpp), named after their key, so they outlive the process and
+ * are shared by every server using the directory. A file that can't be
+ * read is generated and written again.
+ *
+ * At most capacity mazes are kept in memory, the least recently used go
+ * first; mazes still in use elsewhere stay alive through their shared_ptr.
+ * All methods are safe to call from several threads, and threads asking
+ * for the same maze at once wait for one generation.
+ */
+class MazeCache {
+    public:
+    typedef std::shared_ptr<const Maze> maze_ptr;
+
+    private:
+    typedef std::list<MazeKey> lru_list;
+    struct Entry {
+        std::shared_future<maze_ptr> maze;
+        lru_list::iterator used; // position in lru
+    };
+
+    std::string directory;
+    unsigned int threads;
+    size_t capacity;
+
+    mutable std::mutex mutex;
+    std::unordered_map<MazeKey, Entry, MazeKeyHash> entries;
+    /** most recently used first */
+    lru_list lru;
+    size_t hits;
+    size_t misses;
+
+    maze_ptr make(const MazeKey& key) const;
+
+    public:
+    /**
+     * @param directory where to keep maze files, "" for none
+     * @param threads to generate with, see Maze; 0 and any other value
+     * give different mazes, so it is part of the file names too
+     */
+    explicit MazeCache(const std::string& directory = "",
+                       unsigned int threads = 0, size_t capacity = 64);
+
+    /** The maze of key, generated, read from the directory or shared. */
+    maze_ptr get(const MazeKey& key);
+
+    /** The name of key's maze file in the directory. */
+    std::string fileName(const MazeKey& key) const;
+
+    size_t size() const;
+    /** Drops the mazes in memory; the files stay. */
+    void clear();
+
+    /** get() calls answered from memory, and the others. */
+    size_t getHits() const;
+    size_t getMisses() const;
+};
+
+} // end namespace maps
+
+#endif
@@ -0,0 +1,467 @@
+/**
+ * @file maze_codec.cpp
+ * A compact encoding of mazes, for sending them to clients and archiving.
+ *
+ * @since 2026-10-17
+ */
+
+#include "maze_codec.hpp"
+
+#include <algorithm>
+#include <cstring>
+#include <istream>
+#include <ostream>
+#include <vector>
+
+namespace maps {
+
+namespace {
+typedef BitGrid::word_type word_type;
+
+const char MAGIC[4] = {'H', 'X', 'M', 'C'};
+const unsigned char VERSION = 1;
+const size_t B = BitGrid::WORD_BITS;
+const word_type EVEN_BITS = 0x5555555555555555ULL;
+
+/** Bytes out through the stream's buffer, with the stream's error state. */
+struct Writer {
+    std::ostream& stream;
+    std::streambuf& buf;
+    word_type bits; // pending bits of put(), lowest first
+    unsigned int count;
+
+    explicit Writer(std::ostream& stream)
+        : stream(stream)
+        , buf(*stream.rdbuf())
+        , bits(0)
+        , count(0)
+    {}
+
+    inline void
+    byte(unsigned char c) {
+        if (buf.sputc(char(c)) == std::char_traits<char>::eof()) {
+            stream.setstate(std::ios::badbit);
+        }
+    }
+
+    inline void
+    varint(std::uint64_t v) {
+        for (; v >= 0x80; v >>= 7) { byte((v & 0x7f) | 0x80); }
+        byte(v);
+    }
+
+    void
+    float64(double d) {
+        std::uint64_t v;
+        std::memcpy(&v, &d, sizeof(v));
+        for (int i = 0; i < 8; ++i, v >>= 8) { byte(v & 0xff); }
+    }
+
+    /** Appends the low n <= 32 bits of v to the bit stream. */
+    inline void
+    put(word_type v, unsigned int n) {
+        bits |= (v & ((word_type(1) << n) - 1)) << count;
+        for (count += n; count >= 8; count -= 8, bits >>= 8) {
+            byte(bits & 0xff);
+        }
+    }
+
+    /** Ends the bit stream on a byte boundary. */
+    void
+    flush() {
+        if (count) { byte(bits & 0xff); }
+        bits = 0;
+        count = 0;
+    }
+};
+
+/** Bytes in from the stream's buffer; running out is a format error. */
+struct Reader {
+    std::istream& stream;
+    std::streambuf& buf;
+    word_type bits;
+    unsigned int count;
+
+    explicit Reader(std::istream& stream)
+        : stream(stream)
+        , buf(*stream.rdbuf())
+        , bits(0)
+        , count(0)
+    {}
+
+    void
+    fail(const char* why) {
+        stream.setstate(std::ios::failbit);
+        throw err::bad_format() << err::reason(why);
+    }
+
+    inline unsigned char
+    byte() {
+        const int c = buf.sbumpc();
+        if (c == std::char_traits<char>::eof()) {
+            fail("encoded maze is truncated");
+        }
+        return static_cast<unsigned char>(c);
+    }
+
+    inline std::uint64_t
+    varint() {
+        std::uint64_t v = 0;
+        for (unsigned int shift = 0; shift < 64; shift += 7) {
+            const unsigned char c = byte();
+            v |= std::uint64_t(c & 0x7f) << shift;
+            if (!(c & 0x80)) { return v; }
+        }
+        fail("varint too long");
+        return 0;
+    }
+
+    double
+    float64() {
+        std::uint64_t v = 0;
+        for (int i = 0; i < 8; ++i) { v |= std::uint64_t(byte()) << (8 * i); }
+        double d;
+        std::memcpy(&d, &v, sizeof(d));
+        return d;
+    }
+
+    /** The next n <= 32 bits of the bit stream. */
+    inline word_type
+    get(unsigned int n) {
+        for (; count < n; count += 8) { bits |= word_type(byte()) << count; }
+        const word_type v = bits & ((word_type(1) << n) - 1);
+        bits >>= n;
+        count -= n;
+        return v;
+    }
+
+    /** Skips the rest of the byte the bit stream ended in. */
+    void
+    align() {
+        bits = 0;
+        count = 0;
+    }
+};
+
+/** the even bits of w, packed into the low 32 */
+inline word_type
+pack_even(word_type w)
+{
+    w &= EVEN_BITS;
+    w = (w | (w >> 1))  & 0x3333333333333333ULL;
+    w = (w | (w >> 2))  & 0x0f0f0f0f0f0f0f0fULL;
+    w = (w | (w >> 4))  & 0x00ff00ff00ff00ffULL;
+    w = (w | (w >> 8))  & 0x0000ffff0000ffffULL;
+    w = (w | (w >> 16)) & 0x00000000ffffffffULL;
+    return w;
+}
+
+/** the low 32 bits of w, spread out to the even bits */
+inline word_type
+spread_even(word_type w)
+{
+    w &= 0x00000000ffffffffULL;
+    w = (w | (w << 16)) & 0x0000ffff0000ffffULL;
+    w = (w | (w << 8))  & 0x00ff00ff00ff00ffULL;
+    w = (w | (w << 4))  & 0x0f0f0f0f0f0f0f0fULL;
+    w = (w | (w << 2))  & 0x3333333333333333ULL;
+    w = (w | (w << 1))  & EVEN_BITS;
+    return w;
+}
+
+/**
+ * What a maze looks like before it is a maze, word k of row y at a time.
+ * Cells with x + y even are the lattice - pillars where both are even,
+ * rooms where both are odd - which the generators never change; the
+ * others are the links between rooms, where all the maze is.
+ */
+struct Shape {
+    size_t width;
+    size_t height;
+    size_t words_per_row;
+
+    /** cells of word k that are inside the maze */
+    inline word_type
+    inside(size_t k) const {
+        const size_t used = std::min(B, width - k * B);
+        return used == B ? ~word_type(0) : (word_type(1) << used) - 1;
+    }
+
+    /** whether the first link of row y is at an odd x */
+    static inline unsigned int
+    odd(size_t y) { return y % 2 ? 0 : 1; }
+
+    /** the number of links in row y */
+    inline size_t
+    links(size_t y) const { return (width - odd(y) + 1) / 2; }
+
+    inline word_type
+    links(size_t y, size_t k) const {
+        return (EVEN_BITS << odd(y)) & inside(k);
+    }
+
+    inline word_type
+    border(size_t y, size_t k) const {
+        if (y == 0 || y + 1 == height) { return inside(k); }
+        word_type b = k == 0 ? 1 : 0;
+        if (k == (width - 1) / B) { b |= word_type(1) << ((width - 1) % B); }
+        return b;
+    }
+
+    /** the walls predicted for the lattice: pillars and the border */
+    inline word_type
+    lattice(size_t y, size_t k) const {
+        return ((y % 2 ? 0 : EVEN_BITS) & inside(k)) | border(y, k);
+    }
+
+    /**
+     * subtype plane p predicted from the walls: WallTypes::BORDER on the
+     * border, WallTypes::INNER inside and PathTypes::NORMAL paths
+     */
+    inline word_type
+    subtype(size_t p, size_t y, size_t k, word_type walls) const {
+        auto plane = [p](unsigned int t) {
+            return (t >> p) & 1 ? ~word_type(0) : word_type(0);
+        };
+        const word_type b = border(y, k);
+        walls &= inside(k);
+        return (plane(unsigned(WallTypes::BORDER)) & walls & b) |
+               (plane(unsigned(WallTypes::INNER)) & walls & ~b) |
+               (plane(unsigned(PathTypes::NORMAL)) & ~walls & inside(k));
+    }
+};
+
+/**
+ * The first position from pos on where the bit of row is not bit, or
+ * width if there is none before it.
+ */
+inline size_t
+next_change(const word_type* row, size_t pos, bool bit, size_t width)
+{
+    size_t k = pos / B;
+    word_type w = (bit ? ~row[k] : row[k]) & (~word_type(0) << (pos % B));
+    while (!w) {
+        if (++k * B >= width) { return width; }
+        w = bit ? ~row[k] : row[k];
+    }
+    return std::min(width, k * B + __builtin_ctzll(w));
+}
+
+/** flips the bits lo .. hi-1 of row */
+inline void
+flip(word_type* row, size_t lo, size_t hi)
+{
+    while (lo < hi) {
+        const size_t n = std::min(B - lo % B, hi - lo);
+        const word_type mask = n == B ? ~word_type(0)
+                                      : ((word_type(1) << n) - 1) << (lo % B);
+        row[lo / B] ^= mask;
+        lo += n;
+    }
+}
+
+/**
+ * Codes a plane of residuals, which residual(y, row) fills in row by row,
+ * as the lengths of its alternating runs of 0 and 1 bits, starting with
+ * 0s. Runs go on from one row to the next, so a plane without residuals
+ * is a single varint.
+ */
+template <typename Residual>
+void
+encode_runs(Writer& out, const Shape& shape, Residual residual)
+{
+    std::vector<word_type> row(shape.words_per_row);
+    bool bit = false;
+    std::uint64_t run = 0;
+    for (size_t y = 0; y < shape.height; ++y) {
+        residual(y, row.data());
+        for (size_t pos = 0; pos < shape.width; ) {
+            const size_t end = next_change(row.data(), pos, bit, shape.width);
+            run += end - pos;
+            pos = end;
+            if (pos < shape.width) {
+                out.varint(run);
+                run = 0;
+                bit = !bit;
+            }
+        }
+    }
+    out.varint(run);
+}
+
+/** Decodes encode_runs(), flipping the residuals into row(y) in place. */
+template <typename Row>
+void
+decode_runs(Reader& in, const Shape& shape, Row row)
+{
+    const std::uint64_t cells = std::uint64_t(shape.width) * shape.height;
+    std::uint64_t left = in.varint(), done = 0;
+    bool bit = false;
+    for (size_t y = 0; y < shape.height; ++y) {
+        word_type* cur = row(y);
+        for (size_t pos = 0; pos < shape.width; ) {
+            for (; left == 0; bit = !bit) { left = in.varint(); }
+            if (left > cells - done) { in.fail("run past the end of a plane"); }
+            const size_t n = size_t(std::min<std::uint64_t>(
+                left, shape.width - pos));
+            if (bit) { flip(cur, pos, pos + n); }
+            pos += n;
+            done += n;
+            left -= n;
+        }
+    }
+    if (left != 0) { in.fail("run past the end of a plane"); }
+}
+
+void
+encode_objects(Writer& out, const std::vector<Object>& objects)
+{
+    out.varint(objects.size());
+    for (auto& o : objects) {
+        out.varint(o.position.first);
+        out.varint(o.position.second);
+        out.varint(o.value);
+    }
+}
+
+std::vector<Object>
+decode_objects(Reader& in, ObjectType type, size_t width, size_t height)
+{
+    const std::uint64_t n = in.varint();
+    std::vector<Object> objects;
+    // objects may share cells, so n has no bound; a corrupt one runs out
+    // of input long before it runs out of memory
+    objects.reserve(std::min<std::uint64_t>(n, 1 << 16));
+    for (std::uint64_t i = 0; i < n; ++i) {
+        const std::uint64_t x = in.varint(), y = in.varint();
+        const std::uint64_t value = in.varint();
+        if (x >= width || y >= height) { in.fail("object outside the maze"); }
+        objects.push_back(Object{ std::make_pair(size_t(x), size_t(y)),
+                                  type, static_cast<unsigned int>(value) });
+    }
+    return objects;
+}
+} // end anonymous namespace
+
+void
+encode_maze(const Maze& maze, std::ostream& out)
+{
+    const BitGrid& grid = maze.getGrid();
+    const size_t width = grid.getWidth(), height = grid.getHeight();
+    Writer w(out);
+
+    for (char c : MAGIC) { w.byte(c); }
+    w.byte(VERSION);
+    w.varint(width);
+    w.varint(height);
+    w.varint(maze.getSeed());
+    w.float64(maze.getDifficulty());
+    w.varint(maze.getStart().first);
+    w.varint(maze.getStart().second);
+    w.varint(maze.getFinish().first);
+    w.varint(maze.getFinish().second);
+
+    // the lattice, as far as it is not as predicted
+    const Shape shape = { width, height, grid.getWordsPerRow() };
+    encode_runs(w, shape, [&](size_t y, word_type* row) {
+        const word_type* walls = grid.wallRow(y);
+        for (size_t k = 0; k < shape.words_per_row; ++k) {
+            row[k] = (walls[k] ^ shape.lattice(y, k)) & ~shape.links(y, k);
+        }
+    });
+
+    // the links, one bit each
+    for (size_t y = 0; y < height; ++y) {
+        const word_type* walls = grid.wallRow(y);
+        const size_t links = shape.links(y);
+        for (size_t k = 0, done = 0; done < links; ++k, done += 32) {
+            w.put(pack_even(walls[k] >> Shape::odd(y)),
+                  unsigned(std::min<size_t>(32, links - done)));
+        }
+    }
+    w.flush();
+
+    // the subtypes, as far as the walls don't predict them
+    for (size_t p = 0; p < BitGrid::SUBTYPE_PLANES; ++p) {
+        encode_runs(w, shape, [&](size_t y, word_type* row) {
+            const word_type* walls = grid.wallRow(y);
+            const word_type* subtypes = grid.subtypeRow(p, y);
+            for (size_t k = 0; k < shape.words_per_row; ++k) {
+                row[k] = subtypes[k] ^ shape.subtype(p, y, k, walls[k]);
+            }
+        });
+    }
+
+    encode_objects(w, maze.getMonsters());
+    encode_objects(w, maze.getTreasure());
+}
+
+Maze
+decode_maze(std::istream& in, std::uint64_t max_cells)
+{
+    Reader r(in);
+    char magic[4];
+    for (char& c : magic) { c = char(r.byte()); }
+    if (!std::equal(MAGIC, MAGIC + 4, magic)) {
+        r.fail("not an encoded maze");
+    }
+    if (r.byte() != VERSION) { r.fail("unsupported encoded maze version"); }
+
+    const std::uint64_t width = r.varint(), height = r.varint();
+    const std::uint64_t seed = r.varint();
+    const double difficulty = r.float64();
+    std::pair<size_t, size_t> start, finish;
+    start.first   = r.varint();
+    start.second  = r.varint();
+    finish.first  = r.varint();
+    finish.second = r.varint();
+    // a corrupt size must not make us allocate the world
+    if (width == 0 || height == 0 || width > max_cells ||
+        height > max_cells / width ||
+        start.first >= width || start.second >= height ||
+        finish.first >= width || finish.second >= height) {
+        r.fail("bad maze dimensions");
+    }
+
+    BitGrid grid(width, height);
+    const Shape shape = { grid.getWidth(), grid.getHeight(),
+                          grid.getWordsPerRow() };
+
+    // each pass below writes straight into the grid: the lattice as
+    // predicted and corrected, then the links, then the subtypes
+    for (size_t y = 0; y < shape.height; ++y) {
+        word_type* walls = grid.wallRow(y);
+        for (size_t k = 0; k < shape.words_per_row; ++k) {
+            walls[k] = (walls[k] & ~shape.inside(k)) | shape.lattice(y, k);
+        }
+    }
+    decode_runs(r, shape, [&](size_t y) { return grid.wallRow(y); });
+    for (size_t y = 0; y < shape.height; ++y) {
+        word_type* walls = grid.wallRow(y);
+        const size_t links = shape.links(y);
+        for (size_t k = 0, done = 0; done < links; ++k, done += 32) {
+            const unsigned int n = unsigned(std::min<size_t>(32, links - done));
+            walls[k] = (walls[k] & ~shape.links(y, k)) |
+                       (spread_even(r.get(n)) << Shape::odd(y));
+        }
+    }
+    r.align();
+
+    for (size_t p = 0; p < BitGrid::SUBTYPE_PLANES; ++p) {
+        for (size_t y = 0; y < shape.height; ++y) {
+            const word_type* walls = grid.wallRow(y);
+            word_type* subtypes = grid.subtypeRow(p, y);
+            for (size_t k = 0; k < shape.words_per_row; ++k) {
+                subtypes[k] = shape.subtype(p, y, k, walls[k]);
+            }
+        }
+        decode_runs(r, shape, [&](size_t y) { return grid.subtypeRow(p, y); });
+    }
+
+    auto monsters = decode_objects(r, ObjectType::MONSTER, width, height);
+    auto treasure = decode_objects(r, ObjectType::TREASURE, width, height);
+    return Maze(std::move(grid), difficulty, seed, std::move(monsters),
+                std::move(treasure), start, finish);
+}
+
+} // end namespace maps
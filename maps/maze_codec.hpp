@@ -0,0 +1,68 @@
+#ifndef MAZE_CODEC_HPP_GUARD
+#define MAZE_CODEC_HPP_GUARD
+/**
+ * @file maze_codec.hpp
+ * A compact encoding of mazes, for sending them to clients and archiving.
+ *
+ * A generated maze is a lattice of walls and rooms - walls where x and y
+ * are both even, rooms where both are odd, walls all around - and the
+ * maze itself is in the other cells, the links between rooms, which are
+ * walls about half of the time and need one bit each. So the walls are
+ * coded as the links, bit packed, and the lattice as its difference from
+ * the predicted one; the subtypes as their difference from what the walls
+ * predict (WallTypes::BORDER on the border, WallTypes::INNER inside and
+ * PathTypes::NORMAL paths). Differences are coded as the lengths of the
+ * alternating runs of 0 and 1 bits of the rows one after the other,
+ * starting with 0s, as varints: a plane with none is a single varint, and
+ * edited cells cost a few bytes each. A large maze comes out about 6 times
+ * smaller than its bit grid, half the size of its wall plane.
+ *
+ * Layout, version 1 - varints are LEB128, unsigned:
+ * <pre>
+ * "HXMC", version byte
+ * varint width, height, seed
+ * difficulty as 8 little endian bytes of the double
+ * varint start x, y, finish x, y
+ * varint runs of the lattice cells (x + y even) that aren't as predicted
+ * the links (x + y odd), row by row, one bit each, lowest bit of a byte
+ *         first, padded to a whole byte at the end
+ * varint runs of subtype residuals, for each of the BitGrid::SUBTYPE_PLANES
+ * varint monster count, then per monster varint x, y, value
+ * varint treasure count, then per treasure varint x, y, value
+ * </pre>
+ *
+ * @since 2026-10-17
+ */
+
+#include "maze.hpp"
+#include "exceptions.hpp"
+
+#include <cstdint>
+#include <iosfwd>
+
+namespace maps {
+
+/** decode_maze() refuses larger mazes unless told otherwise: 4096 x 4096 */
+const std::uint64_t MAX_DECODED_CELLS = std::uint64_t(1) << 24;
+
+/** Writes the encoding of maze to out. */
+void encode_maze(const Maze& maze, std::ostream& out);
+
+/**
+ * Reads an encoded maze from in, decoding straight into the grid of the
+ * result as the bits arrive; reads exactly the encoding, so more
+ * data may follow it in the stream.
+ *
+ * The grid is allocated as soon as the header is read, before the input
+ * could show the size is a lie, so mazes from untrusted input are capped.
+ *
+ * @param max_cells the largest width * height accepted
+ * @throws err::bad_format if in does not hold an encoded maze, or one of
+ *         more than max_cells cells
+ */
+Maze decode_maze(std::istream& in,
+                 std::uint64_t max_cells = MAX_DECODED_CELLS);
+
+} // end namespace maps
+
+#endif
@@ -0,0 +1,250 @@
+/**
+ * @file maze_file.cpp
+ * The binary maze file format, and a loader that maps it into memory.
+ *
+ * @since 2026-10-17
+ */
+
+#include "maze_file.hpp"
+#include "exceptions.hpp"
+
+#include <algorithm>
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <string>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace maps {
+
+namespace {
+const size_t PLANES = 1 + BitGrid::SUBTYPE_PLANES;
+
+file::FileObject
+to_file(const Object& o)
+{
+    return file::FileObject{
+        o.position.first, o.position.second,
+        static_cast<std::uint32_t>(o.type), o.value };
+}
+
+Object
+from_file(const file::FileObject& o)
+{
+    return Object{
+        std::make_pair(size_t(o.x), size_t(o.y)),
+        static_cast<ObjectType>(o.type), o.value };
+}
+} // end anonymous namespace
+
+void
+save_maze(const Maze& maze, const std::string& path)
+{
+    const BitGrid& grid = maze.getGrid();
+    const size_t wpr = grid.getWordsPerRow();
+    const size_t plane_bytes =
+        grid.getHeight() * wpr * sizeof(BitGrid::word_type);
+
+    file::FileHeader h;
+    std::memset(&h, 0, sizeof(h));
+    std::copy(file::MAGIC, file::MAGIC + 4, h.magic);
+    h.version        = file::VERSION;
+    h.width          = maze.getWidth();
+    h.height         = maze.getHeight();
+    h.seed           = maze.getSeed();
+    h.difficulty     = maze.getDifficulty();
+    h.words_per_row  = wpr;
+    h.planes         = PLANES;
+    h.cells_offset   = sizeof(h);
+    h.objects_offset = h.cells_offset + PLANES * plane_bytes;
+    h.monster_count  = maze.getMonsters().size();
+    h.treasure_count = maze.getTreasure().size();
+    h.start_x        = maze.getStart().first;
+    h.start_y        = maze.getStart().second;
+    h.finish_x       = maze.getFinish().first;
+    h.finish_y       = maze.getFinish().second;
+
+    // truncating path in place would pull the pages from under processes
+    // that have it mapped
+    const std::string tmp = path + ".tmp" + std::to_string(::getpid());
+    std::ofstream out(tmp.c_str(), std::ios::binary | std::ios::trunc);
+    out.write(reinterpret_cast<const char*>(&h), sizeof(h));
+    const std::streamsize row_bytes = wpr * sizeof(BitGrid::word_type);
+    for (size_t y = 0; y < grid.getHeight(); ++y) {
+        out.write(reinterpret_cast<const char*>(grid.wallRow(y)), row_bytes);
+    }
+    for (size_t p = 0; p < BitGrid::SUBTYPE_PLANES; ++p) {
+        for (size_t y = 0; y < grid.getHeight(); ++y) {
+            out.write(reinterpret_cast<const char*>(grid.subtypeRow(p, y)),
+                      row_bytes);
+        }
+    }
+    for (auto list : { &maze.getMonsters(), &maze.getTreasure() }) {
+        for (auto& o : *list) {
+            auto f = to_file(o);
+            out.write(reinterpret_cast<const char*>(&f), sizeof(f));
+        }
+    }
+    out.close();
+    if (!out) {
+        std::remove(tmp.c_str());
+        throw err::io_error() << err::file_name(path)
+                              << err::reason("could not write maze file");
+    }
+    if (std::rename(tmp.c_str(), path.c_str()) != 0) {
+        const int error = errno;
+        std::remove(tmp.c_str());
+        throw err::io_error() << err::file_name(path)
+                              << err::reason(std::strerror(error));
+    }
+}
+
+Maze
+load_maze(const std::string& path)
+{
+    return MappedMaze(path).toMaze();
+}
+
+MappedMaze::MappedMaze(const std::string& path)
+    : data(nullptr)
+    , size(0)
+    , header(nullptr)
+    , walls(nullptr)
+    , subtypes(nullptr)
+    , objects(nullptr)
+{
+    int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0) {
+        throw err::io_error() << err::file_name(path)
+                              << err::reason(std::strerror(errno));
+    }
+    struct stat st;
+    if (::fstat(fd, &st) < 0 || size_t(st.st_size) < sizeof(file::FileHeader)) {
+        ::close(fd);
+        throw err::bad_format() << err::file_name(path)
+                                << err::reason("too short for a maze file");
+    }
+    size = st.st_size;
+    void* m = ::mmap(nullptr, size, PROT_READ, MAP_SHARED, fd, 0);
+    ::close(fd);
+    if (m == MAP_FAILED) {
+        throw err::io_error() << err::file_name(path)
+                              << err::reason(std::strerror(errno));
+    }
+    data = static_cast<const char*>(m);
+    header = reinterpret_cast<const file::FileHeader*>(data);
+
+    // the header may be anything, so the sizes are checked by dividing the
+    // room in the file, never by multiplying what the header says
+    const char* problem = nullptr;
+    const size_t WORD = sizeof(BitGrid::word_type);
+    const size_t OBJECT = sizeof(file::FileObject);
+    if (!std::equal(file::MAGIC, file::MAGIC + 4, header->magic)) {
+        problem = "not a maze file";
+    } else if (header->version != file::VERSION) {
+        problem = "unsupported maze file version";
+    } else if (header->planes != PLANES || header->width == 0 ||
+               header->height == 0 || header->words_per_row !=
+               header->width / BitGrid::WORD_BITS +
+               (header->width % BitGrid::WORD_BITS != 0)) {
+        problem = "cell layout does not match";
+    } else if (header->cells_offset % 8 || header->objects_offset % 8 ||
+               header->cells_offset > size ||
+               header->height > (size - header->cells_offset) / WORD /
+                                PLANES / header->words_per_row ||
+               header->objects_offset > size ||
+               header->monster_count > (size - header->objects_offset) /
+                                       OBJECT ||
+               header->treasure_count > (size - header->objects_offset) /
+                                        OBJECT - header->monster_count) {
+        problem = "maze file is truncated";
+    } else if (header->start_x >= header->width ||
+               header->start_y >= header->height ||
+               header->finish_x >= header->width ||
+               header->finish_y >= header->height) {
+        problem = "start or finish outside the maze";
+    } else {
+        // the objects go into an ObjectIndex, which indexes by position
+        const file::FileObject* o = reinterpret_cast<const file::FileObject*>(
+                data + header->objects_offset);
+        const size_t n = header->monster_count + header->treasure_count;
+        for (size_t i = 0; i < n && !problem; ++i) {
+            if (o[i].x >= header->width || o[i].y >= header->height) {
+                problem = "object outside the maze";
+            }
+        }
+    }
+    if (problem) {
+        ::munmap(const_cast<char*>(data), size);
+        throw err::bad_format() << err::file_name(path)
+                                << err::reason(problem);
+    }
+
+    walls = reinterpret_cast<const BitGrid::word_type*>(
+            data + header->cells_offset);
+    subtypes = walls + header->height * header->words_per_row;
+    objects = reinterpret_cast<const file::FileObject*>(
+            data + header->objects_offset);
+}
+
+MappedMaze::MappedMaze(MappedMaze&& other)
+    : data(other.data)
+    , size(other.size)
+    , header(other.header)
+    , walls(other.walls)
+    , subtypes(other.subtypes)
+    , objects(other.objects)
+{
+    other.data = nullptr;
+}
+
+MappedMaze::~MappedMaze()
+{
+    if (data) { ::munmap(const_cast<char*>(data), size); }
+}
+
+Object
+MappedMaze::monster(size_t i) const
+{
+    assert(i < monsterCount());
+    return from_file(objects[i]);
+}
+
+Object
+MappedMaze::treasure(size_t i) const
+{
+    assert(i < treasureCount());
+    return from_file(objects[monsterCount() + i]);
+}
+
+Maze
+MappedMaze::toMaze() const
+{
+    const size_t wpr = header->words_per_row;
+    BitGrid grid(getWidth(), getHeight());
+    for (size_t y = 0; y < getHeight(); ++y) {
+        std::copy(wallRow(y), wallRow(y) + wpr, grid.wallRow(y));
+        for (size_t p = 0; p < BitGrid::SUBTYPE_PLANES; ++p) {
+            const BitGrid::word_type* from =
+                subtypes + (p * getHeight() + y) * wpr;
+            std::copy(from, from + wpr, grid.subtypeRow(p, y));
+        }
+    }
+    std::vector<Object> monsters, treasure;
+    for (size_t i = 0; i < monsterCount(); ++i) {
+        monsters.push_back(monster(i));
+    }
+    for (size_t i = 0; i < treasureCount(); ++i) {
+        treasure.push_back(this->treasure(i));
+    }
+    return Maze(std::move(grid), getDifficulty(), getSeed(),
+                std::move(monsters), std::move(treasure),
+                getStart(), getFinish());
+}
+
+} // end namespace maps
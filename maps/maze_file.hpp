@@ -0,0 +1,165 @@
+#ifndef MAZE_FILE_HPP_GUARD
+#define MAZE_FILE_HPP_GUARD
+/**
+ * @file maze_file.hpp
+ * The binary maze file format, and a loader that maps it into memory.
+ *
+ * Layout, version 1 - every field in the byte order of the machine that
+ * wrote it, so the mapping can be read in place (a file from a machine of
+ * the other order fails the version check), every section 8 byte aligned:
+ * <pre>
+ * FileHeader
+ * cells:   (1 + BitGrid::SUBTYPE_PLANES) planes of height * words_per_row
+ *          64 bit words, the wall plane first - exactly BitGrid's layout
+ * objects: monster_count monsters, then treasure_count treasures, each a
+ *          FileObject
+ * </pre>
+ *
+ * @since 2026-10-17
+ */
+
+#include "maze.hpp"
+#include "exceptions.hpp"
+
+#include <cstdint>
+#include <string>
+
+namespace maps {
+
+namespace file {
+
+const char MAGIC[4] = {'H', 'X', 'M', 'Z'};
+const std::uint32_t VERSION = 1;
+
+struct FileHeader {
+    char magic[4];
+    std::uint32_t version;
+    std::uint64_t width;
+    std::uint64_t height;
+    std::uint64_t seed;
+    double difficulty;
+    std::uint64_t words_per_row;
+    std::uint64_t planes;
+    /** offsets of the sections from the start of the file, in bytes */
+    std::uint64_t cells_offset;
+    std::uint64_t objects_offset;
+    std::uint64_t monster_count;
+    std::uint64_t treasure_count;
+    std::uint64_t start_x, start_y;
+    std::uint64_t finish_x, finish_y;
+};
+
+struct FileObject {
+    std::uint64_t x, y;
+    std::uint32_t type;
+    std::uint32_t value;
+};
+
+} // end namespace file
+
+/**
+ * Writes the maze to path, replacing the file. The file is written aside
+ * and renamed over path, so MappedMazes of the old file keep it intact.
+ */
+void save_maze(const Maze& maze, const std::string& path);
+
+/** Reads a maze file into an ordinary, modifiable Maze. */
+Maze load_maze(const std::string& path);
+
+/**
+ * A maze file mapped read-only into memory.
+ *
+ * Opening one costs an mmap and a header check whatever the size of the
+ * maze; cells are read straight from the mapping, and processes mapping the
+ * same file share its pages through the page cache.
+ */
+class MappedMaze {
+    const char* data;
+    size_t size;
+    const file::FileHeader* header;
+    const BitGrid::word_type* walls;
+    const BitGrid::word_type* subtypes;
+    const file::FileObject* objects;
+
+    inline size_t
+    index(size_t x, size_t y) const {
+        assert(x < header->width);
+        assert(y < header->height);
+        return y * header->words_per_row + x / BitGrid::WORD_BITS;
+    }
+
+    inline BitGrid::word_type
+    bit(size_t x) const {
+        return BitGrid::word_type(1) << (x % BitGrid::WORD_BITS);
+    }
+
+    public:
+    explicit MappedMaze(const std::string& path);
+    ~MappedMaze();
+
+    MappedMaze(MappedMaze&& other);
+    MappedMaze(const MappedMaze&) = delete;
+    MappedMaze& operator=(const MappedMaze&) = delete;
+
+    inline bool
+    isWall(size_t x, size_t y) const {
+        return walls[index(x, y)] & bit(x);
+    }
+
+    inline bool
+    isPath(size_t x, size_t y) const { return !isWall(x, y); }
+
+    inline WallTypes
+    getWallType(size_t x, size_t y) const {
+        assert(isWall(x, y));
+        return static_cast<WallTypes>(getSubtype(x, y));
+    }
+
+    inline PathTypes
+    getPathType(size_t x, size_t y) const {
+        assert(isPath(x, y));
+        return static_cast<PathTypes>(getSubtype(x, y));
+    }
+
+    inline unsigned int
+    getSubtype(size_t x, size_t y) const {
+        size_t i = index(x, y);
+        size_t plane = header->height * header->words_per_row;
+        unsigned int t = 0;
+        for (size_t p = 0; p < BitGrid::SUBTYPE_PLANES; ++p) {
+            t |= ((subtypes[p * plane + i] & bit(x)) ? 1u : 0u) << p;
+        }
+        return t;
+    }
+
+    /** Wall words of row y, laid out like BitGrid::wallRow(). */
+    inline const BitGrid::word_type*
+    wallRow(size_t y) const {
+        assert(y < header->height);
+        return walls + y * header->words_per_row;
+    }
+
+    size_t getWidth()  const { return header->width; }
+    size_t getHeight() const { return header->height; }
+    std::uint64_t getSeed() const { return header->seed; }
+    double getDifficulty()  const { return header->difficulty; }
+
+    std::pair<size_t, size_t> getStart() const {
+        return std::make_pair(header->start_x, header->start_y);
+    }
+    std::pair<size_t, size_t> getFinish() const {
+        return std::make_pair(header->finish_x, header->finish_y);
+    }
+
+    size_t monsterCount()  const { return header->monster_count; }
+    size_t treasureCount() const { return header->treasure_count; }
+    Object monster(size_t i) const;
+    Object treasure(size_t i) const;
+
+    /** Copies the mapping into an ordinary Maze. */
+    Maze toMaze() const;
+};
+
+} // end namespace maps
+
+#endif
@@ -7,12 +7,882 @@
  */
 
 #include "maze.hpp"
+#include "chunked_maze.hpp"
+#include "connectivity.hpp"
+#include "corridor_graph.hpp"
+#include "distance_field.hpp"
+#include "dungeon.hpp"
+#include "eller.hpp"
+#include "fixed_maze.hpp"
+#include "flow_field.hpp"
+#include "hierarchical_pathfinder.hpp"
+#include "maze_cache.hpp"
+#include "maze_codec.hpp"
+#include "maze_file.hpp"
+#include "neighborhood.hpp"
+#include "pathfinder.hpp"
+#include "pvs.hpp"
+#include "visibility.hpp"
+
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <cstddef>
+#include <cstdio>
+#include <cstdlib>
+#include <deque>
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <sstream>
+
+/** true if both mazes have the same layout */
+bool same_layout(const maps::Maze& a, const maps::Maze& b)
+{
+    if (a.getWidth() != b.getWidth() || a.getHeight() != b.getHeight()) {
+        return false;
+    }
+    for (size_t y = 0; y < a.getHeight(); ++y) {
+        for (size_t x = 0; x < a.getWidth(); ++x) {
+            if (a.isWall(x, y) != b.isWall(x, y)) { return false; }
+        }
+    }
+    return a.getStart() == b.getStart() && a.getFinish() == b.getFinish();
+}
+
+/** true if both lists hold the same objects in the same order */
+bool same_objects(const std::vector<maps::Object>& a,
+                  const std::vector<maps::Object>& b)
+{
+    if (a.size() != b.size()) { return false; }
+    for (size_t i = 0; i < a.size(); ++i) {
+        if (a[i].position != b[i].position || a[i].type != b[i].type ||
+            a[i].value != b[i].value) {
+            return false;
+        }
+    }
+    return true;
+}
+
+/** true if both mazes are the same in every cell, object and parameter */
+bool same_maze(const maps::Maze& a, const maps::Maze& b)
+{
+    if (!same_layout(a, b)) { return false; }
+    for (size_t y = 0; y < a.getHeight(); ++y) {
+        for (size_t x = 0; x < a.getWidth(); ++x) {
+            if (a.getGrid().getSubtype(x, y) != b.getGrid().getSubtype(x, y)) {
+                return false;
+            }
+        }
+    }
+    return a.getSeed() == b.getSeed() &&
+           a.getDifficulty() == b.getDifficulty() &&
+           same_objects(a.getMonsters(), b.getMonsters()) &&
+           same_objects(a.getTreasure(), b.getTreasure());
+}
+
+/** a path cell of maze, picked by rng */
+std::pair<size_t, size_t> random_path(const maps::Maze& maze,
+                                      utility::generator& rng)
+{
+    for (;;) {
+        size_t x = rng.bounded(maze.getWidth());
+        size_t y = rng.bounded(maze.getHeight());
+        if (maze.isPath(x, y)) { return std::make_pair(x, y); }
+    }
+}
+
+/** true if both fields have the same distances, and a's steps follow them */
+bool same_flow(const maps::Maze& maze, const maps::FlowField& a,
+               const maps::FlowField& b)
+{
+    for (size_t y = 0; y < maze.getHeight(); ++y) {
+        for (size_t x = 0; x < maze.getWidth(); ++x) {
+            auto d = a.distance(x, y);
+            if (d != b.distance(x, y)) { return false; }
+            if (d != 0 && d != maps::FlowField::UNREACHABLE) {
+                auto n = a.nextCell(x, y);
+                if (a.distance(n.first, n.second) != d - 1) { return false; }
+            }
+        }
+    }
+    return a.getTargets() == b.getTargets();
+}
+
+/** a maze with every cell a wall with probability 1/3 - open, unlike a
+ * generated one, so searches have many equally short paths to pick from */
+maps::Maze open_maze(size_t width, size_t height, std::uint64_t seed)
+{
+    utility::generator rng(seed);
+    maps::BitGrid grid(width, height);
+    for (size_t y = 0; y < height; ++y) {
+        for (size_t x = 0; x < width; ++x) {
+            grid.set(x, y, rng.bounded(3) == 0, 0);
+        }
+    }
+    return maps::Maze(std::move(grid), 1, seed);
+}
+
+/** a maze with walls on its border only */
+maps::Maze empty_maze(size_t width, size_t height, std::uint64_t seed)
+{
+    maps::BitGrid grid(width, height);
+    for (size_t y = 0; y < height; ++y) {
+        for (size_t x = 0; x < width; ++x) {
+            grid.set(x, y, x == 0 || y == 0 ||
+                           x + 1 == width || y + 1 == height, 0);
+        }
+    }
+    return maps::Maze(std::move(grid), 1, seed);
+}
+
+/** steps from from to every cell of maze, -1 where there is no path */
+std::vector<long> bfs(const maps::Maze& maze, std::pair<size_t, size_t> from)
+{
+    const size_t w = maze.getWidth(), h = maze.getHeight();
+    std::vector<long> dist(w * h, -1);
+    std::deque<std::pair<size_t, size_t>> frontier(1, from);
+    dist[from.second * w + from.first] = 0;
+    while (!frontier.empty()) {
+        auto c = frontier.front();
+        frontier.pop_front();
+        const long d = dist[c.second * w + c.first];
+        const std::pair<size_t, size_t> around[4] = {
+            { c.first + 1, c.second }, { c.first - 1, c.second },
+            { c.first, c.second + 1 }, { c.first, c.second - 1 } };
+        for (auto n : around) {
+            // unsigned wrap makes -1 fail the bounds test too
+            if (n.first < w && n.second < h && maze.isPath(n.first, n.second) &&
+                dist[n.second * w + n.first] < 0) {
+                dist[n.second * w + n.first] = d + 1;
+                frontier.push_back(n);
+            }
+        }
+    }
+    return dist;
+}
+
+/** true if path goes from a to b over path cells, a step at a time */
+bool valid_path(const maps::Maze& maze,
+                const std::vector<std::pair<size_t, size_t>>& path,
+                std::pair<size_t, size_t> a, std::pair<size_t, size_t> b)
+{
+    if (path.empty() || path.front() != a || path.back() != b) {
+        return false;
+    }
+    for (size_t i = 0; i < path.size(); ++i) {
+        if (!maze.isPath(path[i].first, path[i].second)) { return false; }
+        if (i > 0) {
+            const size_t dx = path[i].first  > path[i-1].first
+                ? path[i].first  - path[i-1].first
+                : path[i-1].first  - path[i].first;
+            const size_t dy = path[i].second > path[i-1].second
+                ? path[i].second - path[i-1].second
+                : path[i-1].second - path[i].second;
+            if (dx + dy != 1) { return false; }
+        }
+    }
+    return true;
+}
+
+/** builds or knocks down a random inner cell of maze, which it returns */
+std::pair<size_t, size_t> random_edit(maps::Maze& maze,
+                                      utility::generator& rng)
+{
+    const size_t x = 1 + rng.bounded(maze.getWidth() - 2);
+    const size_t y = 1 + rng.bounded(maze.getHeight() - 2);
+    if (maze.isWall(x, y)) {
+        maze.destroyWall(x, y);
+    } else {
+        maze.buildWall(x, y);
+    }
+    return std::make_pair(x, y);
+}
+
+/** true if both fields hold the same value in every cell */
+bool same_field(const maps::DistanceField& a, const maps::DistanceField& b)
+{
+    for (size_t y = 0; y < a.getHeight(); ++y) {
+        for (size_t x = 0; x < a.getWidth(); ++x) {
+            if (a.distance(x, y) != b.distance(x, y)) { return false; }
+        }
+    }
+    return true;
+}
+
+/** true if a and b split the maze into the same regions, whatever labels */
+bool same_regions(const maps::Maze& maze, const maps::Connectivity& a,
+                  const maps::Connectivity& b)
+{
+    typedef maps::Connectivity::region_type region_type;
+    if (a.regionCount() != b.regionCount()) { return false; }
+    std::map<region_type, region_type> ab, ba;
+    for (size_t y = 0; y < maze.getHeight(); ++y) {
+        for (size_t x = 0; x < maze.getWidth(); ++x) {
+            region_type ra = a.regionOf(x, y), rb = b.regionOf(x, y);
+            if ((ra == maps::Connectivity::NO_REGION) !=
+                (rb == maps::Connectivity::NO_REGION)) {
+                return false;
+            }
+            if (ra == maps::Connectivity::NO_REGION) { continue; }
+            if (ab.insert(std::make_pair(ra, rb)).first->second != rb ||
+                ba.insert(std::make_pair(rb, ra)).first->second != ra ||
+                a.regionSize(ra) != b.regionSize(rb)) {
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+/** true if both hold the same mask for every cell */
+bool same_masks(const maps::Neighborhood& a, const maps::Neighborhood& b,
+                size_t width, size_t height)
+{
+    for (size_t y = 0; y < height; ++y) {
+        for (size_t x = 0; x < width; ++x) {
+            if (a.mask(x, y) != b.mask(x, y)) { return false; }
+        }
+    }
+    return true;
+}
+
+/** true if every cell of a is the cell of b at an offset of (x0, y0) */
+bool same_cells(const maps::BitGrid& a, const maps::BitGrid& b,
+                size_t x0, size_t y0)
+{
+    for (size_t y = 0; y < a.getHeight(); ++y) {
+        for (size_t x = 0; x < a.getWidth(); ++x) {
+            if (a.isWall(x, y) != b.isWall(x + x0, y + y0) ||
+                a.getSubtype(x, y) != b.getSubtype(x + x0, y + y0)) {
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+/** a stream buffer that can't seek, like a socket's */
+struct UnseekableBuf : std::stringbuf {
+    explicit UnseekableBuf(const std::string& s) : std::stringbuf(s) {}
+
+    pos_type
+    seekoff(off_type, std::ios_base::seekdir, std::ios_base::openmode) {
+        return pos_type(off_type(-1));
+    }
+
+    pos_type
+    seekpos(pos_type, std::ios_base::openmode) {
+        return pos_type(off_type(-1));
+    }
+};
 
 int main( int argc, char *argv[] )
 {
     using namespace maps;
 
-    auto maze = Maze(31, 13, 1);
+    auto seed = (argc > 1) ? std::strtoull(argv[1], NULL, 0)
+                           : utility::generator::DEFAULT_SEED;
+    auto maze = Maze(31, 13, 1, seed);
+
+    // the seed alone determines the maze
+    assert(same_layout(maze, Maze(31, 13, 1, seed)));
+    // start and finish are always on a path
+    assert(maze.isPath(maze.getStart().first, maze.getStart().second));
+    assert(maze.isPath(maze.getFinish().first, maze.getFinish().second));
+    // and the treasure can be reached from them
+    std::vector<Connectivity::cell> objects{ maze.getStart(), maze.getFinish() };
+    for (auto& t : maze.getTreasure()) { objects.push_back(t.position); }
+    assert(Connectivity(maze).sameRegion(objects));
+
+    // floors past the lookahead are not generated until asked for; the
+    // stairs lead from the top of a dungeon to its bottom, a step or a
+    // connector at a time
+    Dungeon dungeon(31, 13, 4, 1, seed);
+    assert(!dungeon.isReady(3));
+    std::vector<Place> path;
+    assert(dungeon.reachable(dungeon.getStart(), dungeon.getFinish()));
+    assert(dungeon.findPath(dungeon.getStart(), dungeon.getFinish(), path));
+    assert(path.front() == dungeon.getStart());
+    assert(path.back() == dungeon.getFinish());
+    for (size_t i = 1; i < path.size(); ++i) {
+        const Place& a = path[i - 1];
+        const Place& b = path[i];
+        bool step = false;
+        if (a.level == b.level) {
+            const long dx = long(a.position.first)  - long(b.position.first);
+            const long dy = long(a.position.second) - long(b.position.second);
+            step = std::labs(dx) + std::labs(dy) == 1 &&
+                   dungeon.level(b.level).isPath(b.position.first,
+                                                 b.position.second);
+        }
+        for (auto& c : dungeon.connectors(a.level)) {
+            step = step || (c.from == a && c.to == b);
+        }
+        assert(step);
+    }
+
+    // chunks read the same however often they were evicted and generated
+    // again, the chunks of a window make one region, and pinned chunks
+    // stay generated
+    {
+        ChunkedMaze tight(seed, 16, 1), roomy(seed, 16, 256);
+        BitGrid window(67, 67);
+        for (size_t y = 0; y < 67; ++y) {
+            for (size_t x = 0; x < 67; ++x) {
+                window.set(x, y, true, 0);
+            }
+        }
+        for (int pass = 0; pass < 2; ++pass) {
+            for (ChunkedMaze::coord_type y = -32; y < 32; ++y) {
+                for (ChunkedMaze::coord_type x = -32; x < 32; ++x) {
+                    assert(tight.isWall(x, y) == roomy.isWall(x, y));
+                    window.set(size_t(x + 33), size_t(y + 33),
+                               roomy.isWall(x, y), 0);
+                }
+            }
+        }
+        assert(tight.loadedChunks() == 1);
+        const Maze chunks(std::move(window), 1, seed);
+        assert(Connectivity(chunks).regionCount() == 1);
+
+        tight.pin(0, 0);
+        for (ChunkedMaze::coord_type x = 16; x < 160; ++x) {
+            tight.isWall(x, 0);
+        }
+        assert(tight.loadedChunks() == 2);
+        assert(tight.isWall(5, 5) == roomy.isWall(5, 5));
+        tight.unpin(0, 0);
+        tight.isWall(200, 0);
+        assert(tight.loadedChunks() == 1);
+    }
+
+    // the tiled generator makes the same maze on any number of threads, and
+    // stitches its tiles into one region
+    {
+        const Maze one(601, 545, 1, seed, 1), four(601, 545, 1, seed, 4);
+        assert(same_maze(one, four));
+        assert(Connectivity(one).regionCount() == 1);
+    }
+
+    // the object index answers rect and radius queries as a scan over the
+    // placed objects does, also after objects moved and were taken
+    {
+        Maze m(101, 61, 1, seed);
+        ObjectIndex& index = m.getObjects();
+        std::vector<Object> live(m.getMonsters());
+        live.insert(live.end(), m.getTreasure().begin(), m.getTreasure().end());
+        std::vector<bool> taken(live.size(), false);
+        assert(index.size() == live.size());
+        for (size_t h = 0; h < live.size(); ++h) {
+            assert(index.get(h).position == live[h].position);
+        }
+        utility::generator rng(seed);
+        auto check = [&]() {
+            std::vector<ObjectIndex::handle_type> found, expected;
+            for (int q = 0; q < 100; ++q) {
+                const size_t x0 = rng.bounded(101), y0 = rng.bounded(61);
+                const size_t x1 = x0 + rng.bounded(30);
+                const size_t y1 = y0 + rng.bounded(20);
+                index.inRect(x0, y0, x1, y1, found);
+                expected.clear();
+                for (size_t h = 0; h < live.size(); ++h) {
+                    const auto& p = live[h].position;
+                    if (!taken[h] && x0 <= p.first && p.first <= x1 &&
+                        y0 <= p.second && p.second <= y1) {
+                        expected.push_back(h);
+                    }
+                }
+                std::sort(found.begin(), found.end());
+                assert(found == expected);
+
+                const double x = rng.bounded(1100) / 10.0 - 5;
+                const double y = rng.bounded(700) / 10.0 - 5;
+                const double r = rng.bounded(150) / 10.0;
+                index.inRadius(x, y, r, found);
+                expected.clear();
+                for (size_t h = 0; h < live.size(); ++h) {
+                    const double dx = double(live[h].position.first) - x;
+                    const double dy = double(live[h].position.second) - y;
+                    if (!taken[h] && dx * dx + dy * dy <= r * r) {
+                        expected.push_back(h);
+                    }
+                }
+                std::sort(found.begin(), found.end());
+                assert(found == expected);
+            }
+        };
+        check();
+        for (int i = 0; i < 20; ++i) {
+            const size_t h = rng.bounded(live.size());
+            live[h].position = ObjectIndex::cell(rng.bounded(101),
+                                                 rng.bounded(61));
+            index.move(h, live[h].position);
+        }
+        check();
+        size_t left = live.size();
+        for (int i = 0; i < 10; ++i) {
+            const size_t h = rng.bounded(live.size());
+            if (taken[h]) { continue; }
+            index.remove(h);
+            taken[h] = true;
+            --left;
+            assert(!index.contains(h));
+        }
+        assert(index.size() == left);
+        check();
+    }
+
+    // the batched collision test answers what isPath() does, and blocks
+    // positions outside the maze, negative and not a number ones too
+    {
+        const Maze m(101, 61, 1, seed);
+        utility::generator rng(seed);
+        std::vector<double> xs, ys;
+        for (int i = 0; i < 1000; ++i) {
+            xs.push_back(rng.bounded(11000) / 100.0 - 5);
+            ys.push_back(rng.bounded(7000) / 100.0 - 5);
+        }
+        xs.push_back(std::nan(""));
+        ys.push_back(1.5);
+        xs.push_back(1.5);
+        ys.push_back(-HUGE_VAL);
+        std::vector<std::uint64_t> mask((xs.size() + 63) / 64);
+        m.isPathBatch(xs.data(), ys.data(), xs.size(), mask.data());
+        for (size_t i = 0; i < xs.size(); ++i) {
+            const bool inside = xs[i] >= 0 && ys[i] >= 0 &&
+                                xs[i] < 101 && ys[i] < 61;
+            assert(bool((mask[i / 64] >> (i % 64)) & 1) ==
+                   (inside && m.isPath(size_t(xs[i]), size_t(ys[i]))));
+        }
+    }
+
+    // a FixedMaze is the serial Maze of its seed, walls, start and finish,
+    // and its batched collision test answers what isPath() does, blocking
+    // positions outside the maze
+    for (std::uint64_t s = seed; s < seed + 5; ++s) {
+        const FixedMaze<41, 43> fixed(1, s);
+        const Maze m(41, 43, 1, s, 0);
+        for (size_t y = 0; y < 43; ++y) {
+            for (size_t x = 0; x < 41; ++x) {
+                assert(fixed.isWall(x, y) == m.isWall(x, y));
+            }
+        }
+        assert(fixed.getStart() == m.getStart());
+        assert(fixed.getFinish() == m.getFinish());
+
+        utility::generator rng(s);
+        std::vector<double> xs, ys;
+        for (int i = 0; i < 1000; ++i) {
+            xs.push_back(rng.bounded(5000) / 100.0 - 4.5);
+            ys.push_back(rng.bounded(5200) / 100.0 - 4.5);
+        }
+        std::vector<std::uint64_t> mask((xs.size() + 63) / 64);
+        fixed.isPathBatch(xs.data(), ys.data(), xs.size(), mask.data());
+        for (size_t i = 0; i < xs.size(); ++i) {
+            const bool inside = xs[i] >= 0 && ys[i] >= 0 &&
+                                xs[i] < 41 && ys[i] < 43;
+            assert(bool((mask[i / 64] >> (i % 64)) & 1) ==
+                   (inside && fixed.isPath(size_t(xs[i]), size_t(ys[i]))));
+        }
+    }
+
+    // an Eller maze is one region; written as rows it reads back whole,
+    // also from a stream that can't seek, and as windows; a corrupt header
+    // or short rows are refused
+    {
+        const EllerGenerator eller(61, 41, seed);
+        const BitGrid grid = eller.generate();
+        const Maze m(grid, 1, seed);
+        assert(Connectivity(m).regionCount() == 1);
+
+        std::stringstream out;
+        eller.generate(RowWriter(out, eller.getWidth(), eller.getHeight()));
+        const std::string rows = out.str();
+        std::istringstream whole(rows);
+        BitGrid read = read_rows(whole);
+        assert(read.getWidth() == 61 && read.getHeight() == 41);
+        assert(same_cells(read, grid, 0, 0));
+        UnseekableBuf buf(rows);
+        std::istream stream(&buf);
+        assert(same_cells(read_rows(stream), grid, 0, 0));
+
+        std::istringstream part(rows);
+        read = read_rows(part, 10, 7, 20, 15);
+        assert(read.getWidth() == 20 && read.getHeight() == 15);
+        assert(same_cells(read, grid, 10, 7));
+        std::istringstream edge(rows);
+        read = read_rows(edge, 50, 30, ~size_t(0), ~size_t(0));
+        assert(read.getWidth() == 11 && read.getHeight() == 11);
+        assert(same_cells(read, grid, 50, 30));
+
+        std::vector<std::string> bad(3, rows);
+        const std::uint64_t lies[2] = { 0, std::uint64_t(1) << 40 };
+        bad[0].replace(4, 8, reinterpret_cast<const char*>(&lies[0]), 8);
+        bad[1].replace(12, 8, reinterpret_cast<const char*>(&lies[1]), 8);
+        bad[2].resize(rows.size() - 8);
+        for (auto& b : bad) {
+            UnseekableBuf unseekable(b);
+            std::istream from_socket(&unseekable);
+            std::istringstream from_file(b);
+            std::istream* streams[2] = { &from_file, &from_socket };
+            for (auto in : streams) {
+                try {
+                    read_rows(*in);
+                    assert(false);
+                } catch (const err::bad_format&) {
+                }
+            }
+        }
+    }
+
+    // a maze file reads back as the maze that was saved, and saving over a
+    // file leaves a mapping of the old one intact
+    const std::string file_name = "maze_test.hxmz";
+    const Maze other(31, 13, 1, seed + 1);
+    save_maze(maze, file_name);
+    {
+        MappedMaze mapped(file_name);
+        save_maze(other, file_name);
+        assert(same_maze(maze, mapped.toMaze()));
+    }
+    assert(same_maze(other, load_maze(file_name)));
+    // a header claiming more than the file holds is refused, and so are a
+    // start, finish or object outside the maze
+    auto corrupt = [&](size_t offset, std::uint64_t value) {
+        save_maze(other, file_name);
+        {
+            std::fstream f(file_name.c_str(),
+                           std::ios::in | std::ios::out | std::ios::binary);
+            f.seekp(offset);
+            f.write(reinterpret_cast<const char*>(&value), sizeof(value));
+        }
+        try {
+            load_maze(file_name);
+            assert(false);
+        } catch (const err::bad_format&) {
+        }
+    };
+    corrupt(offsetof(file::FileHeader, height), std::uint64_t(1) << 62);
+    corrupt(offsetof(file::FileHeader, start_x), other.getWidth());
+    corrupt(offsetof(file::FileHeader, finish_y), other.getHeight());
+    file::FileHeader header;
+    std::ifstream(file_name.c_str(), std::ios::binary).read(
+            reinterpret_cast<char*>(&header), sizeof(header));
+    assert(!other.getMonsters().empty());
+    corrupt(header.objects_offset + offsetof(file::FileObject, y),
+            other.getHeight());
+    std::remove(file_name.c_str());
+
+    // the cache generates a maze once, and reads it back from its file
+    // after the memory was dropped
+    {
+        MazeCache cache(".", 0, 2);
+        const MazeKey key(31, 13, 1, seed);
+        MazeCache::maze_ptr made = cache.get(key);
+        assert(cache.get(key) == made);
+        assert(cache.getHits() == 1 && cache.getMisses() == 1);
+        assert(std::ifstream(cache.fileName(key).c_str()).good());
+        cache.clear();
+        MazeCache::maze_ptr read = cache.get(key);
+        assert(read != made && same_maze(*made, *read));
+        std::remove(cache.fileName(key).c_str());
+    }
+
+    // an encoded maze decodes to the maze, also after runtime edits and with
+    // another encoding after it; every cut short encoding is refused, and
+    // so is a header of more cells than the caller allows, before the grid
+    // is allocated
+    {
+        Maze edited(61, 41, 1, seed);
+        utility::generator rng(seed);
+        for (int i = 0; i < 30; ++i) { random_edit(edited, rng); }
+        std::stringstream both;
+        encode_maze(maze, both);
+        encode_maze(edited, both);
+        assert(same_maze(maze, decode_maze(both)));
+        assert(same_maze(edited, decode_maze(both)));
+
+        std::ostringstream out;
+        encode_maze(other, out);
+        const std::string code = out.str();
+        std::vector<std::string> bad;
+        for (size_t n = 0; n < code.size(); ++n) {
+            bad.push_back(code.substr(0, n));
+        }
+        // 2^18 x 2^18 cells, seed 0, difficulty 0, start and finish (0, 0)
+        bad.push_back(std::string("HXMC\x01\x80\x80\x10\x80\x80\x10\x00", 12) +
+                      std::string(8, '\0') + std::string(4, '\0'));
+        for (auto& b : bad) {
+            std::istringstream in(b);
+            try {
+                decode_maze(in);
+                assert(false);
+            } catch (const err::bad_format&) {
+            }
+        }
+        std::istringstream small(code);
+        try {
+            decode_maze(small, other.getWidth() * other.getHeight() - 1);
+            assert(false);
+        } catch (const err::bad_format&) {
+        }
+    }
+
+    // sight is symmetric, a batch answers what single rays do, the path
+    // cells of a field of view can all be seen, and on open ground a field
+    // of view is the disc
+    {
+        const Maze m(61, 41, 1, seed);
+        const Visibility vis(m);
+        utility::generator rng(seed);
+        std::vector<Visibility::Ray> rays;
+        for (int i = 0; i < 3000; ++i) {
+            const Visibility::cell a = random_path(m, rng);
+            const Visibility::cell b(
+                std::min<size_t>(a.first + rng.bounded(25) - 12, 60),
+                std::min<size_t>(a.second + rng.bounded(25) - 12, 40));
+            assert(vis.canSee(a, b) == vis.canSee(b, a));
+            rays.push_back(Visibility::Ray{ a, b });
+        }
+        std::vector<std::uint64_t> mask((rays.size() + 63) / 64);
+        vis.canSeeBatch(rays.data(), rays.size(), mask.data());
+        for (size_t i = 0; i < rays.size(); ++i) {
+            assert(bool((mask[i / 64] >> (i % 64)) & 1) ==
+                   vis.canSee(rays[i].from, rays[i].to));
+        }
+
+        std::vector<Visibility::cell> visible;
+        for (int i = 0; i < 50; ++i) {
+            const Visibility::cell o = random_path(m, rng);
+            vis.fieldOfView(o, 10, visible);
+            for (auto& c : visible) {
+                assert(m.isWall(c.first, c.second) || vis.canSee(o, c));
+            }
+        }
+
+        const Maze open = empty_maze(41, 41, seed);
+        const Visibility clear(open);
+        clear.fieldOfView(Visibility::cell(20, 20), 12, visible);
+        std::sort(visible.begin(), visible.end());
+        std::vector<Visibility::cell> disc;
+        for (size_t y = 8; y <= 32; ++y) {
+            for (size_t x = 8; x <= 32; ++x) {
+                const long dx = long(x) - 20, dy = long(y) - 20;
+                if (dx * dx + dy * dy <= 144) {
+                    disc.push_back(Visibility::cell(x, y));
+                }
+            }
+        }
+        std::sort(disc.begin(), disc.end());
+        assert(visible == disc);
+    }
+
+    // a pvs file reads back as the sets that were saved, and is refused for
+    // another maze or when its header claims more than the file holds
+    {
+        const std::string pvs_name = "maze_test.hxpv";
+        const Maze m(61, 41, 1, seed);
+        utility::generator rng(seed);
+        const PotentiallyVisibleSet pvs(m, 8, 2);
+        save_pvs(pvs, pvs_name);
+        const PotentiallyVisibleSet loaded = load_pvs(pvs_name, m);
+        assert(loaded.getRadius() == pvs.getRadius());
+        assert(loaded.memoryUsage() == pvs.memoryUsage());
+        size_t seen = 0;
+        for (int i = 0; i < 20000; ++i) {
+            const PotentiallyVisibleSet::cell a(rng.bounded(m.getWidth()),
+                                                rng.bounded(m.getHeight()));
+            const PotentiallyVisibleSet::cell b(a.first + rng.bounded(17) - 8,
+                                                a.second + rng.bounded(17) - 8);
+            assert(loaded.isVisible(a, b) == pvs.isVisible(a, b));
+            seen += pvs.isVisible(a, b);
+        }
+        assert(seen > 0);
+
+        Maze edited = m;
+        random_edit(edited, rng);
+        try {
+            load_pvs(pvs_name, edited);
+            assert(false);
+        } catch (const err::bad_format&) {
+        }
+        {
+            std::fstream f(pvs_name.c_str(),
+                           std::ios::in | std::ios::out | std::ios::binary);
+            const std::uint64_t entries = std::uint64_t(1) << 62;
+            f.seekp(offsetof(file::PvsHeader, entries));
+            f.write(reinterpret_cast<const char*>(&entries), sizeof(entries));
+        }
+        try {
+            load_pvs(pvs_name, m);
+            assert(false);
+        } catch (const err::bad_format&) {
+        }
+        std::remove(pvs_name.c_str());
+    }
+
+    // retargeting a flow field gives what setting the targets afresh does,
+    // also with targets listed twice
+    {
+        const Maze big(101, 61, 1, seed);
+        utility::generator rng(seed);
+        FlowField moved(big), fresh(big);
+        std::vector<FlowField::cell> targets(2, random_path(big, rng));
+        moved.setTargets(targets);
+        targets.pop_back();
+        moved.retarget(targets);
+        fresh.setTargets(targets);
+        assert(same_flow(big, moved, fresh));
+
+        targets.push_back(random_path(big, rng));
+        targets.push_back(random_path(big, rng));
+        for (int step = 0; step < 200; ++step) {
+            auto& t = targets[rng.bounded(targets.size())];
+            switch (rng.bounded(3)) {
+                case 0:  t = random_path(big, rng); break;
+                case 1:  t = targets[rng.bounded(targets.size())]; break;
+                default: // a step, as players move
+                    auto n = std::make_pair(t.first + 1, t.second);
+                    if (n.first < big.getWidth() &&
+                        big.isPath(n.first, n.second)) {
+                        t = n;
+                    }
+            }
+            moved.retarget(targets);
+            fresh.setTargets(targets);
+            assert(same_flow(big, moved, fresh));
+        }
+    }
+
+    // the pathfinder's paths are as short as breadth first search's, on a
+    // maze and on an open grid, with and without the cache
+    for (const Maze& m : { Maze(101, 61, 1, seed), open_maze(97, 59, seed) }) {
+        utility::generator rng(seed);
+        Pathfinder finder(m), uncached(m, 0);
+        Pathfinder::path_type found;
+        for (int i = 0; i < 20; ++i) {
+            auto from = random_path(m, rng);
+            auto dist = bfs(m, from);
+            for (int j = 0; j < 20; ++j) {
+                auto to = random_path(m, rng);
+                const long d = dist[to.second * m.getWidth() + to.first];
+                assert(finder.distance(from, to) == d);
+                assert(uncached.distance(from, to) == d);
+                assert(finder.findPath(from, to, found) == (d >= 0));
+                assert(d < 0 || (valid_path(m, found, from, to) &&
+                                 long(found.size()) == d + 1));
+            }
+        }
+    }
+
+    // so are the corridor graph's, from nodes and from inside corridors
+    for (const Maze& m : { Maze(101, 61, 1, seed), open_maze(97, 59, seed) }) {
+        utility::generator rng(seed);
+        CorridorGraph graph(m);
+        std::vector<CorridorGraph::cell> found;
+        for (int i = 0; i < 20; ++i) {
+            auto from = random_path(m, rng);
+            auto dist = bfs(m, from);
+            for (int j = 0; j < 20; ++j) {
+                auto to = random_path(m, rng);
+                const long d = dist[to.second * m.getWidth() + to.first];
+                assert(graph.distance(from, to) == d);
+                assert(graph.path(from, to, found) == (d >= 0));
+                assert(d < 0 || (valid_path(m, found, from, to) &&
+                                 long(found.size()) == d + 1));
+            }
+        }
+    }
+
+    // a distance field kept up to date with cellChanged() is the one built
+    // afresh, also after edits far from any wall
+    {
+        Maze m(101, 61, 1, seed);
+        utility::generator rng(seed);
+        DistanceField kept(m);
+        for (int i = 0; i < 100; ++i) {
+            auto c = random_edit(m, rng);
+            kept.cellChanged(c.first, c.second);
+            if (i % 10 == 0) { assert(same_field(kept, DistanceField(m))); }
+        }
+        Maze empty = open_maze(61, 41, seed);
+        for (size_t y = 1; y + 1 < empty.getHeight(); ++y) {
+            for (size_t x = 1; x + 1 < empty.getWidth(); ++x) {
+                empty.destroyWall(x, y);
+            }
+        }
+        DistanceField open(empty);
+        empty.buildWall(30, 20);
+        open.cellChanged(30, 20);
+        assert(same_field(open, DistanceField(empty)));
+        empty.destroyWall(30, 20);
+        open.cellChanged(30, 20);
+        assert(same_field(open, DistanceField(empty)));
+    }
+
+    // replaying the journal into cellChanged() brings the connectivity,
+    // neighborhood and distance field to where rebuilding them would; the
+    // dirty rectangles cover every journaled cell
+    {
+        Maze m = open_maze(67, 45, seed);
+        utility::generator rng(seed);
+        Connectivity regions(m);
+        Neighborhood around(m.getGrid());
+        DistanceField field(m);
+        for (int tick = 0; tick < 20; ++tick) {
+            for (int i = 0; i < 8; ++i) { random_edit(m, rng); }
+            for (auto& c : m.getJournal()) {
+                bool covered = false;
+                for (auto& r : m.getDirtyRects()) {
+                    covered = covered || (r.x0 <= c.x && c.x < r.x1 &&
+                                          r.y0 <= c.y && c.y < r.y1);
+                }
+                assert(covered);
+                assert(c.before != c.after);
+                regions.cellChanged(c.x, c.y);
+                around.cellChanged(c.x, c.y);
+                field.cellChanged(c.x, c.y);
+            }
+            m.clearChanges();
+            assert(m.getJournal().empty());
+            assert(same_regions(m, regions, Connectivity(m)));
+            assert(same_masks(around, Neighborhood(m.getGrid()),
+                              m.getWidth(), m.getHeight()));
+            assert(same_field(field, DistanceField(m)));
+        }
+    }
+
+    // HPA* kept up to date with cellChanged() plans what one built afresh
+    // does, and its paths are walkable, never shorter than the shortest
+    {
+        Maze m(101, 61, 1, seed);
+        utility::generator rng(seed);
+        HierarchicalPathfinder kept(m, 16);
+        HierarchicalPathfinder::path_type found;
+        for (int round = 0; round < 5; ++round) {
+            for (int i = 0; i < 40; ++i) {
+                auto c = random_edit(m, rng);
+                kept.cellChanged(c.first, c.second);
+            }
+            HierarchicalPathfinder fresh(m, 16);
+            assert(kept.nodeCount() == fresh.nodeCount());
+            for (int i = 0; i < 10; ++i) {
+                auto from = random_path(m, rng);
+                auto dist = bfs(m, from);
+                for (int j = 0; j < 10; ++j) {
+                    auto to = random_path(m, rng);
+                    const long d = dist[to.second * m.getWidth() + to.first];
+                    const long planned = kept.distance(from, to);
+                    assert(planned == fresh.distance(from, to));
+                    assert((planned < 0) == (d < 0) && planned >= d);
+                    assert(kept.findPath(from, to, found) == (d >= 0));
+                    assert(d < 0 || (valid_path(m, found, from, to) &&
+                                     long(found.size()) == planned + 1));
+                }
+            }
+        }
+    }
 
     for (size_t i = 0; i < maze.getWidth(); ++i) {
         for (size_t j = 0; j < maze.getHeight(); ++j) {
@@ -0,0 +1,105 @@
+/**
+ * @file neighborhood.cpp
+ * Per cell masks of the surrounding walls, and what they make of a cell.
+ *
+ * @since 2026-10-17
+ */
+
+#include "neighborhood.hpp"
+
+#include <algorithm>
+
+namespace maps {
+
+const Neighborhood::mask_type Neighborhood::SOUTH_WEST;
+const Neighborhood::mask_type Neighborhood::SOUTH;
+const Neighborhood::mask_type Neighborhood::SOUTH_EAST;
+const Neighborhood::mask_type Neighborhood::WEST;
+const Neighborhood::mask_type Neighborhood::EAST;
+const Neighborhood::mask_type Neighborhood::NORTH_WEST;
+const Neighborhood::mask_type Neighborhood::NORTH;
+const Neighborhood::mask_type Neighborhood::NORTH_EAST;
+const Neighborhood::mask_type Neighborhood::ORTHOGONAL;
+
+const int Neighborhood::DX[8] = { -1, 0, 1, -1, 1, -1,  0,  1 };
+const int Neighborhood::DY[8] = {  1, 1, 1,  0, 0, -1, -1, -1 };
+
+Neighborhood::Neighborhood(const BitGrid& grid)
+    : grid(grid)
+    , width(grid.getWidth())
+    , height(grid.getHeight())
+    , masks(width * height)
+{
+    for (size_t y = 0; y < height; ++y) { compute_row(y); }
+}
+
+/*
+ * Word k of neighbor b holds the walls at (64k + i + dx, y + dy) for every
+ * i, so bit i of the eight words together is the mask of cell 64k + i.
+ * The spreading loop has no branches and vectorizes.
+ */
+void
+Neighborhood::compute_row(size_t y)
+{
+    const size_t B = BitGrid::WORD_BITS;
+    const BitGrid& g = grid.get();
+    BitGrid::word_type words[8];
+    for (size_t x0 = 0; x0 < width; x0 += B) {
+        for (int b = 0; b < 8; ++b) {
+            words[b] = g.wallWord(std::ptrdiff_t(x0) + DX[b],
+                                  std::ptrdiff_t(y)  + DY[b]);
+        }
+        mask_type spread[64];
+        for (size_t i = 0; i < B; ++i) {
+            mask_type m = 0;
+            for (int b = 0; b < 8; ++b) {
+                m |= mask_type(((words[b] >> i) & 1) << b);
+            }
+            spread[i] = m;
+        }
+        const size_t n = std::min(B, width - x0);
+        std::copy(spread, spread + n, masks.begin() + (y * width + x0));
+    }
+}
+
+void
+Neighborhood::cellChanged(size_t x, size_t y)
+{
+    for (int b = 0; b < 8; ++b) {
+        const std::ptrdiff_t nx = std::ptrdiff_t(x) + DX[b];
+        const std::ptrdiff_t ny = std::ptrdiff_t(y) + DY[b];
+        if (nx < 0 || ny < 0 || size_t(nx) >= width || size_t(ny) >= height) {
+            continue;
+        }
+        // (x, y) is the neighbor in the opposite direction, bit 7 - b
+        mask_type& m = masks[ny * width + nx];
+        const mask_type bit = mask_type(1 << (7 - b));
+        m = grid.get().isWall(x, y) ? (m | bit) : (m & ~bit);
+    }
+}
+
+std::vector<Neighborhood::cell>
+Neighborhood::cellsOf(CellClass c) const
+{
+    std::vector<cell> cells;
+    for (size_t y = 1; y + 1 < height; ++y) {
+        for (size_t x = 1; x + 1 < width; ++x) {
+            if (classify(x, y) == c) { cells.push_back(cell(x, y)); }
+        }
+    }
+    return cells;
+}
+
+std::vector<Neighborhood::cell>
+Neighborhood::blindEnds() const
+{
+    std::vector<cell> cells;
+    for (size_t y = 1; y + 1 < height; ++y) {
+        for (size_t x = 1; x + 1 < width; ++x) {
+            if (isBlindEnd(x, y)) { cells.push_back(cell(x, y)); }
+        }
+    }
+    return cells;
+}
+
+} // end namespace maps
@@ -0,0 +1,119 @@
+#ifndef NEIGHBORHOOD_HPP_GUARD
+#define NEIGHBORHOOD_HPP_GUARD
+/**
+ * @file neighborhood.hpp
+ * Per cell masks of the surrounding walls, and what they make of a cell.
+ *
+ * @since 2026-10-17
+ */
+
+#include "bitgrid.hpp"
+
+#include <cstdint>
+#include <functional>
+#include <utility>
+#include <vector>
+
+namespace maps {
+
+/** What a cell is, judged by its 4 neighbors. */
+enum class CellClass : std::uint8_t {
+    WALL,
+    ISOLATED,  // no open neighbor
+    DEAD_END,  // one
+    CORRIDOR,  // two
+    JUNCTION   // three or four
+};
+
+/**
+ * For every cell, a byte with a bit per neighbor that is a wall (cells
+ * outside the grid count as walls). The masks are computed a row of 64
+ * cells at a time: each neighbor direction is one shifted word of the wall
+ * plane, and the eight words are spread into the cells' bytes.
+ *
+ * Placement code asks the masks instead of calling isWall() eight times per
+ * cell; call cellChanged() after editing the grid to keep them current.
+ */
+class Neighborhood {
+    public:
+    typedef std::uint8_t mask_type;
+    typedef std::pair<size_t, size_t> cell;
+
+    /* neighbor bits; y grows to the south */
+    static const mask_type SOUTH_WEST = 1 << 0;
+    static const mask_type SOUTH      = 1 << 1;
+    static const mask_type SOUTH_EAST = 1 << 2;
+    static const mask_type WEST       = 1 << 3;
+    static const mask_type EAST       = 1 << 4;
+    static const mask_type NORTH_WEST = 1 << 5;
+    static const mask_type NORTH      = 1 << 6;
+    static const mask_type NORTH_EAST = 1 << 7;
+    static const mask_type ORTHOGONAL = SOUTH | WEST | EAST | NORTH;
+
+    /** (dx, dy) of neighbor bit b */
+    static const int DX[8];
+    static const int DY[8];
+
+    private:
+    std::reference_wrapper<const BitGrid> grid;
+    size_t width;
+    size_t height;
+    std::vector<mask_type> masks;
+
+    void compute_row(size_t y);
+
+    public:
+    explicit Neighborhood(const BitGrid& grid);
+
+    /** Recomputes the masks around (x, y) after it changed. */
+    void cellChanged(size_t x, size_t y);
+
+    /** The walls around (x, y). */
+    inline mask_type
+    mask(size_t x, size_t y) const {
+        assert(x < width);
+        assert(y < height);
+        return masks[y * width + x];
+    }
+
+    inline unsigned int
+    wallCount(size_t x, size_t y) const {
+        return __builtin_popcount(mask(x, y));
+    }
+
+    inline CellClass
+    classify(size_t x, size_t y) const {
+        if (grid.get().isWall(x, y)) { return CellClass::WALL; }
+        unsigned int open = 4 - __builtin_popcount(mask(x, y) & ORTHOGONAL);
+        return open >= 3 ? CellClass::JUNCTION
+                         : static_cast<CellClass>(
+                               unsigned(CellClass::ISOLATED) + open);
+    }
+
+    /**
+     * A path cell with one open neighbor out of all eight, diagonals
+     * included - a pocket fit to hide treasure in.
+     */
+    inline bool
+    isBlindEnd(size_t x, size_t y) const {
+        return !grid.get().isWall(x, y) && wallCount(x, y) == 7;
+    }
+
+    /** The (dx, dy) of the one open neighbor of a blind end. */
+    inline std::pair<int, int>
+    exitOf(size_t x, size_t y) const {
+        assert(isBlindEnd(x, y));
+        int b = __builtin_ctz(mask_type(~mask(x, y)));
+        return std::make_pair(DX[b], DY[b]);
+    }
+
+    /** All cells of class c inside the border, in row-major order. */
+    std::vector<cell> cellsOf(CellClass c) const;
+
+    /** All blind ends inside the border, in row-major order. */
+    std::vector<cell> blindEnds() const;
+};
+
+} // end namespace maps
+
+#endif
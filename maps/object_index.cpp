@@ -0,0 +1,108 @@
+/**
+ * @file object_index.cpp
+ * The objects of a maze, bucketed by position for proximity queries.
+ *
+ * @since 2026-10-17
+ */
+
+#include "object_index.hpp"
+
+namespace maps {
+
+const std::uint32_t ObjectIndex::NO_BUCKET;
+
+ObjectIndex::ObjectIndex(size_t width, size_t height, size_t bucket_size)
+    : bucket_size(std::max<size_t>(bucket_size, 1))
+    , buckets_x(std::max<size_t>((width  + this->bucket_size - 1)
+                                 / this->bucket_size, 1))
+    , buckets_y(std::max<size_t>((height + this->bucket_size - 1)
+                                 / this->bucket_size, 1))
+    , buckets(buckets_x * buckets_y)
+    , entries()
+    , free_handles()
+{}
+
+void
+ObjectIndex::link(handle_type h)
+{
+    Entry& e = entries[h];
+    const cell& p = e.object.position;
+    e.bucket = std::uint32_t(bucketY(p.second) * buckets_x + bucketX(p.first));
+    e.slot = std::uint32_t(buckets[e.bucket].size());
+    buckets[e.bucket].push_back(h);
+}
+
+/* swaps the last handle of the bucket into h's slot */
+void
+ObjectIndex::unlink(handle_type h)
+{
+    Entry& e = entries[h];
+    std::vector<handle_type>& bucket = buckets[e.bucket];
+    const handle_type last = bucket.back();
+    bucket[e.slot] = last;
+    entries[last].slot = e.slot;
+    bucket.pop_back();
+    e.bucket = NO_BUCKET;
+}
+
+ObjectIndex::handle_type
+ObjectIndex::insert(const Object& object)
+{
+    handle_type h;
+    if (free_handles.empty()) {
+        h = handle_type(entries.size());
+        entries.push_back(Entry{ object, NO_BUCKET, 0 });
+    } else {
+        h = free_handles.back();
+        free_handles.pop_back();
+        entries[h].object = object;
+    }
+    link(h);
+    return h;
+}
+
+void
+ObjectIndex::remove(handle_type h)
+{
+    assert(contains(h));
+    unlink(h);
+    free_handles.push_back(h);
+}
+
+void
+ObjectIndex::move(handle_type h, cell to)
+{
+    assert(contains(h));
+    Entry& e = entries[h];
+    const std::uint32_t bucket =
+        std::uint32_t(bucketY(to.second) * buckets_x + bucketX(to.first));
+    if (bucket == e.bucket) {
+        e.object.position = to;
+        return;
+    }
+    unlink(h);
+    e.object.position = to;
+    link(h);
+}
+
+void
+ObjectIndex::inRect(size_t x0, size_t y0, size_t x1, size_t y1,
+                    std::vector<handle_type>& out) const
+{
+    out.clear();
+    forEachInRect(x0, y0, x1, y1, [&](handle_type h, const Object&) {
+        out.push_back(h);
+    });
+}
+
+void
+ObjectIndex::inRadius(double x, double y, double radius,
+                      std::vector<handle_type>& out) const
+{
+    out.clear();
+    forEachInRadius(x, y, radius, [&](handle_type h, const Object&) {
+        out.push_back(h);
+    });
+}
+
+} // end namespace maps
@@ -0,0 +1,146 @@
+#ifndef OBJECT_INDEX_HPP_GUARD
+#define OBJECT_INDEX_HPP_GUARD
+/**
+ * @file object_index.hpp
+ * The objects of a maze, bucketed by position for proximity queries.
+ *
+ * @since 2026-10-17
+ */
+
+#include <algorithm>
+#include <cassert>
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+namespace maps {
+
+enum class ObjectType {
+    TREASURE,
+    MONSTER,
+    START,
+    END
+};
+
+struct Object {
+    std::pair<size_t, size_t> position;
+    ObjectType type;
+    // difficulty for monsters (higer - more difficult)
+    // type for treasures (maybe upgrade goo?)
+    unsigned int value;
+};
+
+/**
+ * A uniform grid of buckets over the maze, each holding the objects within
+ * a square of cells. Proximity queries only visit the buckets the query
+ * area overlaps, so they cost the number of objects nearby rather than the
+ * number of objects in the maze.
+ *
+ * Objects are referred to by the handle insert() returns; handles of
+ * removed objects are reused. Insertion, removal and moves are O(1).
+ */
+class ObjectIndex {
+    public:
+    typedef std::uint32_t handle_type;
+    typedef std::pair<size_t, size_t> cell;
+
+    private:
+    struct Entry {
+        Object object;
+        std::uint32_t bucket; // NO_BUCKET when the handle is free
+        std::uint32_t slot;   // position in the bucket
+    };
+    static const std::uint32_t NO_BUCKET = ~std::uint32_t(0);
+
+    size_t bucket_size;
+    size_t buckets_x;
+    size_t buckets_y;
+    std::vector<std::vector<handle_type>> buckets;
+    std::vector<Entry> entries;
+    std::vector<handle_type> free_handles;
+
+    inline size_t
+    bucketX(size_t x) const { return std::min(x / bucket_size, buckets_x - 1); }
+
+    inline size_t
+    bucketY(size_t y) const { return std::min(y / bucket_size, buckets_y - 1); }
+
+    void link(handle_type h);
+    void unlink(handle_type h);
+
+    public:
+    /** An empty index over a width x height maze. */
+    explicit ObjectIndex(size_t width = 0, size_t height = 0,
+                         size_t bucket_size = 8);
+
+    handle_type insert(const Object& object);
+    void remove(handle_type h);
+    /** Moves object h to cell to. */
+    void move(handle_type h, cell to);
+
+    inline const Object&
+    get(handle_type h) const {
+        assert(contains(h));
+        return entries[h].object;
+    }
+
+    inline bool
+    contains(handle_type h) const {
+        return h < entries.size() && entries[h].bucket != NO_BUCKET;
+    }
+
+    size_t size() const { return entries.size() - free_handles.size(); }
+
+    /**
+     * Calls f(handle, object) for every object in the cells
+     * [x0, x1] x [y0, y1].
+     */
+    template <typename F>
+    void
+    forEachInRect(size_t x0, size_t y0, size_t x1, size_t y1, F f) const {
+        if (x0 > x1 || y0 > y1 || buckets.empty()) { return; }
+        for (size_t by = bucketY(y0); by <= bucketY(y1); ++by) {
+            for (size_t bx = bucketX(x0); bx <= bucketX(x1); ++bx) {
+                for (auto h : buckets[by * buckets_x + bx]) {
+                    const cell& p = entries[h].object.position;
+                    if (p.first >= x0 && p.first <= x1 &&
+                        p.second >= y0 && p.second <= y1) {
+                        f(h, entries[h].object);
+                    }
+                }
+            }
+        }
+    }
+
+    /**
+     * Calls f(handle, object) for every object whose cell lies within
+     * radius of (x, y).
+     */
+    template <typename F>
+    void
+    forEachInRadius(double x, double y, double radius, F f) const {
+        if (radius < 0) { return; }
+        const double r2 = radius * radius;
+        if (x + radius < 0 || y + radius < 0) { return; }
+        auto clamp = [](double v) { return v > 0 ? size_t(v) : size_t(0); };
+        forEachInRect(clamp(x - radius), clamp(y - radius),
+                      clamp(x + radius), clamp(y + radius),
+                      [&](handle_type h, const Object& o) {
+                          double dx = double(o.position.first) - x;
+                          double dy = double(o.position.second) - y;
+                          if (dx * dx + dy * dy <= r2) { f(h, o); }
+                      });
+    }
+
+    /** The handles of the objects in [x0, x1] x [y0, y1], into out. */
+    void inRect(size_t x0, size_t y0, size_t x1, size_t y1,
+                std::vector<handle_type>& out) const;
+
+    /** The handles of the objects within radius of (x, y), into out. */
+    void inRadius(double x, double y, double radius,
+                  std::vector<handle_type>& out) const;
+};
+
+} // end namespace maps
+
+#endif
@@ -0,0 +1,282 @@
+/**
+ * @file pathfinder.cpp
+ * Point to point shortest paths over a Maze.
+ *
+ * @since 2026-10-17
+ */
+
+#include "pathfinder.hpp"
+#include "stamped_set.hpp"
+
+#include <algorithm>
+#include <cstdlib>
+#include <thread>
+
+namespace maps {
+
+namespace {
+typedef BitGrid::word_type word_type;
+const long NONE = -1;
+
+struct Node {
+    std::uint32_t f;
+    std::uint32_t cell;
+    bool operator<(const Node& o) const { return f > o.f; } // min-heap
+};
+
+/** Search state of one thread, reused by all its searches. */
+struct Workspace {
+    std::vector<std::uint32_t> g;
+    std::vector<std::uint32_t> parent;
+    StampedSet seen;
+    StampedSet closed;
+    std::vector<Node> open;
+
+    Workspace() : g(), parent(), seen(), closed(), open() {}
+
+    /** Starts a new search on a grid of n cells. */
+    void
+    begin(size_t n)
+    {
+        if (g.size() != n) {
+            g.resize(n);
+            parent.resize(n);
+        }
+        seen.clear(n);
+        closed.clear(n);
+        open.clear();
+    }
+};
+
+thread_local Workspace workspace;
+
+/**
+ * Jumps from (x, y) along the row in direction dx until it reaches the
+ * goal or a cell with a forced neighbor - an open cell above or below
+ * whose predecessor along the row is a wall, which a vertical-first path
+ * could not have reached. Works on 64 cells at a time.
+ *
+ * @return the x of the jump point, or NONE if a wall comes first
+ */
+long
+jump_horizontal(const BitGrid& grid, long x, long y, int dx, long gx, long gy)
+{
+    const long B = BitGrid::WORD_BITS;
+    if (dx > 0) {
+        for (long start = x + 1; ; start += B) {
+            word_type blocked = grid.wallWord(start, y);
+            word_type forced =
+                (grid.pathWord(start, y-1) & grid.wallWord(start-1, y-1)) |
+                (grid.pathWord(start, y+1) & grid.wallWord(start-1, y+1));
+            word_type goal = (y == gy && gx >= start && gx < start + B)
+                ? word_type(1) << (gx - start) : 0;
+            word_type stop = blocked | forced | goal;
+            if (stop) {
+                int i = __builtin_ctzll(stop);
+                return (blocked >> i) & 1 ? NONE : start + i;
+            }
+        }
+    } else {
+        for (long end = x - 1; ; end -= B) {
+            long base = end - (B - 1); // bit i is cell base + i
+            word_type blocked = grid.wallWord(base, y);
+            word_type forced =
+                (grid.pathWord(base, y-1) & grid.wallWord(base+1, y-1)) |
+                (grid.pathWord(base, y+1) & grid.wallWord(base+1, y+1));
+            word_type goal = (y == gy && gx >= base && gx <= end)
+                ? word_type(1) << (gx - base) : 0;
+            word_type stop = blocked | forced | goal;
+            if (stop) {
+                int i = 63 - __builtin_clzll(stop);
+                return (blocked >> i) & 1 ? NONE : base + i;
+            }
+        }
+    }
+}
+
+/**
+ * Jumps from (x, y) along the column in direction dy. A cell is a jump
+ * point if it is the goal or if a horizontal jump from it finds one.
+ *
+ * @return the y of the jump point, or NONE if a wall comes first
+ */
+long
+jump_vertical(const BitGrid& grid, long x, long y, int dy, long gx, long gy)
+{
+    for (;;) {
+        y += dy;
+        if (grid.wallWord(x, y) & 1) { return NONE; }
+        if (x == gx && y == gy) { return y; }
+        if (jump_horizontal(grid, x, y,  1, gx, gy) != NONE ||
+            jump_horizontal(grid, x, y, -1, gx, gy) != NONE) {
+            return y;
+        }
+    }
+}
+
+inline int
+sign(long v) { return (v > 0) - (v < 0); }
+} // end anonymous namespace
+
+Pathfinder::Pathfinder(const Maze& maze, size_t cache_capacity)
+    : maze(maze)
+    , cache_capacity(cache_capacity)
+    , cache_lock()
+    , cache()
+    , cache_revision(maze.getRevision())
+{}
+
+bool
+Pathfinder::search(cell from, cell to, path_type& path) const
+{
+    const BitGrid& grid = maze.get().getGrid();
+    const long width = long(grid.getWidth());
+    path.clear();
+    if (!maze.get().isPath(from.first, from.second) ||
+        !maze.get().isPath(to.first, to.second)) {
+        return false;
+    }
+
+    Workspace& ws = workspace;
+    ws.begin(grid.getWidth() * grid.getHeight());
+    const long gx = long(to.first), gy = long(to.second);
+    auto h = [&](long x, long y) {
+        return std::uint32_t(std::labs(x - gx) + std::labs(y - gy));
+    };
+    auto push = [&](long x, long y, std::uint32_t g, std::uint32_t parent) {
+        std::uint32_t c = std::uint32_t(y * width + x);
+        if (ws.closed.contains(c)) { return; }
+        if (ws.seen.contains(c) && ws.g[c] <= g) { return; }
+        ws.seen.insert(c);
+        ws.g[c]      = g;
+        ws.parent[c] = parent;
+        ws.open.push_back(Node{ g + h(x, y), c });
+        std::push_heap(ws.open.begin(), ws.open.end());
+    };
+
+    const std::uint32_t start = std::uint32_t(from.second * width + from.first);
+    const std::uint32_t goal  = std::uint32_t(gy * width + gx);
+    push(long(from.first), long(from.second), 0, start);
+
+    bool found = false;
+    while (!ws.open.empty()) {
+        std::pop_heap(ws.open.begin(), ws.open.end());
+        const std::uint32_t c = ws.open.back().cell;
+        ws.open.pop_back();
+        if (ws.closed.contains(c)) { continue; }
+        ws.closed.insert(c);
+        if (c == goal) { found = true; break; }
+
+        const long x = c % width, y = c / width;
+        const long px = ws.parent[c] % width, py = ws.parent[c] / width;
+        const int dx = sign(x - px), dy = sign(y - py);
+        const std::uint32_t g = ws.g[c];
+
+        auto horizontal = [&](int d) {
+            long jx = jump_horizontal(grid, x, y, d, gx, gy);
+            if (jx != NONE) { push(jx, y, g + std::labs(jx - x), c); }
+        };
+        auto vertical = [&](int d) {
+            long jy = jump_vertical(grid, x, y, d, gx, gy);
+            if (jy != NONE) { push(x, jy, g + std::labs(jy - y), c); }
+        };
+
+        if (c == start) {
+            horizontal(1); horizontal(-1); vertical(1); vertical(-1);
+        } else if (dy) {
+            // arrived vertically: keep going, or turn either way
+            vertical(dy); horizontal(1); horizontal(-1);
+        } else {
+            // arrived horizontally: keep going, turn only where forced
+            horizontal(dx);
+            for (int ny : { -1, 1 }) {
+                if (!(grid.wallWord(x, y+ny) & 1) &&
+                     (grid.wallWord(x-dx, y+ny) & 1)) {
+                    vertical(ny);
+                }
+            }
+        }
+    }
+    if (!found) { return false; }
+
+    // walk the jump points back, filling in the straight runs between them
+    for (std::uint32_t c = goal; ; c = ws.parent[c]) {
+        long x = c % width, y = c / width;
+        long px = ws.parent[c] % width, py = ws.parent[c] / width;
+        int dx = sign(px - x), dy = sign(py - y);
+        do {
+            path.push_back(cell(x, y));
+            x += dx;
+            y += dy;
+        } while (x != px || y != py);
+        if (c == start) { break; }
+    }
+    std::reverse(path.begin(), path.end());
+    return true;
+}
+
+bool
+Pathfinder::findPath(cell from, cell to, path_type& path)
+{
+    if (cache_capacity == 0) { return search(from, to, path); }
+
+    const std::uint64_t k = key(from, to);
+    {
+        std::lock_guard<std::mutex> lock(cache_lock);
+        if (cache_revision != maze.get().getRevision()) {
+            cache.clear();
+            cache_revision = maze.get().getRevision();
+        }
+        auto it = cache.find(k);
+        if (it != cache.end()) {
+            path = it->second;
+            return !path.empty();
+        }
+    }
+
+    bool found = search(from, to, path);
+
+    std::lock_guard<std::mutex> lock(cache_lock);
+    if (cache_revision == maze.get().getRevision()) {
+        if (cache.size() >= cache_capacity) { cache.clear(); }
+        cache[k] = path;
+    }
+    return found;
+}
+
+void
+Pathfinder::findPaths(const std::vector<Query>& queries,
+                      std::vector<path_type>& paths,
+                      unsigned int threads)
+{
+    paths.resize(queries.size());
+    threads = std::max(1u, threads);
+
+    auto worker = [&](size_t first) {
+        for (size_t i = first; i < queries.size(); i += threads) {
+            findPath(queries[i].from, queries[i].to, paths[i]);
+        }
+    };
+    std::vector<std::thread> pool;
+    for (unsigned int t = 1; t < threads; ++t) {
+        pool.emplace_back(worker, t);
+    }
+    worker(0);
+    for (auto& th : pool) { th.join(); }
+}
+
+long
+Pathfinder::distance(cell from, cell to)
+{
+    thread_local path_type path;
+    return findPath(from, to, path) ? long(path.size()) - 1 : -1;
+}
+
+void
+Pathfinder::clearCache()
+{
+    std::lock_guard<std::mutex> lock(cache_lock);
+    cache.clear();
+}
+
+} // end namespace maps
@@ -0,0 +1,252 @@
+/**
+ * @file pvs.cpp
+ * Precomputed potentially visible sets of the cells of a maze.
+ *
+ * @since 2026-10-17
+ */
+
+#include "pvs.hpp"
+#include "visibility.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <cstring>
+#include <fstream>
+#include <thread>
+
+namespace maps {
+
+namespace {
+const size_t C = PotentiallyVisibleSet::CLUSTER_SIZE;
+
+/** A hash of the walls of grid, to tell a pvs file of another maze. */
+std::uint64_t
+hash_walls(const BitGrid& grid)
+{
+    const BitGrid::word_type* w = grid.wallData();
+    const size_t n = grid.getHeight() * grid.getWordsPerRow();
+    std::uint64_t h = grid.getWidth();
+    h = utility::splitmix64(h) ^ grid.getHeight();
+    for (size_t i = 0; i < n; ++i) {
+        std::uint64_t s = h ^ w[i];
+        h = utility::splitmix64(s);
+    }
+    return h;
+}
+
+/** The sets of one row of cells, entries relative to the row. */
+struct RowSets {
+    std::vector<std::uint32_t> counts; // entries per cell
+    std::vector<std::uint32_t> clusters;
+    std::vector<std::uint64_t> bits;
+
+    RowSets() : counts(), clusters(), bits() {}
+};
+
+/** Appends the set of the cells in visible to row, as (cluster, mask). */
+void
+compress(const std::vector<Visibility::cell>& visible, size_t clusters_x,
+         std::vector<std::pair<std::uint32_t, std::uint64_t>>& scratch,
+         RowSets& row)
+{
+    scratch.clear();
+    for (auto& v : visible) {
+        const std::uint32_t id =
+            std::uint32_t((v.second / C) * clusters_x + v.first / C);
+        scratch.push_back(std::make_pair(
+            id, std::uint64_t(1) << ((v.second % C) * C + v.first % C)));
+    }
+    std::sort(scratch.begin(), scratch.end());
+    std::uint32_t count = 0;
+    for (size_t i = 0; i < scratch.size(); ) {
+        std::uint64_t mask = 0;
+        const std::uint32_t id = scratch[i].first;
+        for (; i < scratch.size() && scratch[i].first == id; ++i) {
+            mask |= scratch[i].second;
+        }
+        row.clusters.push_back(id);
+        row.bits.push_back(mask);
+        ++count;
+    }
+    row.counts.push_back(count);
+}
+} // end anonymous namespace
+
+const size_t PotentiallyVisibleSet::CLUSTER_SIZE;
+
+PotentiallyVisibleSet::PotentiallyVisibleSet()
+    : width(0)
+    , height(0)
+    , radius(0)
+    , clusters_x(0)
+    , walls(0)
+    , offsets(1, 0)
+    , clusters()
+    , bits()
+{}
+
+PotentiallyVisibleSet::PotentiallyVisibleSet(const Maze& maze, size_t radius,
+                                             unsigned int threads)
+    : width(maze.getWidth())
+    , height(maze.getHeight())
+    , radius(radius)
+    , clusters_x((maze.getWidth() + C - 1) / C)
+    , walls(hash_walls(maze.getGrid()))
+    , offsets()
+    , clusters()
+    , bits()
+{
+    Visibility visibility(maze);
+    std::vector<RowSets> rows(height);
+    std::atomic<size_t> next_row(0);
+
+    auto work = [&]() {
+        std::vector<Visibility::cell> visible;
+        std::vector<std::pair<std::uint32_t, std::uint64_t>> scratch;
+        for (size_t y = next_row++; y < height; y = next_row++) {
+            RowSets& row = rows[y];
+            for (size_t x = 0; x < width; ++x) {
+                if (maze.isPath(x, y)) {
+                    visibility.fieldOfView(Visibility::cell(x, y), radius,
+                                           visible);
+                } else {
+                    visible.clear();
+                }
+                compress(visible, clusters_x, scratch, row);
+            }
+        }
+    };
+    std::vector<std::thread> pool;
+    for (unsigned int t = 1; t < threads; ++t) { pool.emplace_back(work); }
+    work();
+    for (auto& t : pool) { t.join(); }
+
+    // concatenate the rows in order, so the result does not depend on
+    // which thread built which row
+    size_t entries = 0;
+    for (auto& row : rows) { entries += row.clusters.size(); }
+    offsets.reserve(width * height + 1);
+    clusters.reserve(entries);
+    bits.reserve(entries);
+    offsets.push_back(0);
+    for (auto& row : rows) {
+        for (auto n : row.counts) { offsets.push_back(offsets.back() + n); }
+        clusters.insert(clusters.end(), row.clusters.begin(),
+                        row.clusters.end());
+        bits.insert(bits.end(), row.bits.begin(), row.bits.end());
+        row = RowSets();
+    }
+}
+
+bool
+PotentiallyVisibleSet::isVisible(cell from, cell to) const
+{
+    if (from.first >= width || from.second >= height ||
+        to.first >= width || to.second >= height) {
+        return false;
+    }
+    const size_t i = from.second * width + from.first;
+    const auto begin = clusters.begin() + offsets[i];
+    const auto end = clusters.begin() + offsets[i + 1];
+    const std::uint32_t id =
+        std::uint32_t((to.second / C) * clusters_x + to.first / C);
+    const auto it = std::lower_bound(begin, end, id);
+    if (it == end || *it != id) { return false; }
+    return (bits[it - clusters.begin()] >>
+            ((to.second % C) * C + to.first % C)) & 1;
+}
+
+void
+save_pvs(const PotentiallyVisibleSet& pvs, const std::string& path)
+{
+    file::PvsHeader h;
+    std::memset(&h, 0, sizeof(h));
+    std::copy(file::PVS_MAGIC, file::PVS_MAGIC + 4, h.magic);
+    h.version = file::PVS_VERSION;
+    h.width   = pvs.width;
+    h.height  = pvs.height;
+    h.radius  = pvs.radius;
+    h.entries = pvs.clusters.size();
+    h.walls   = pvs.walls;
+
+    std::ofstream out(path.c_str(), std::ios::binary | std::ios::trunc);
+    out.write(reinterpret_cast<const char*>(&h), sizeof(h));
+    out.write(reinterpret_cast<const char*>(pvs.offsets.data()),
+              pvs.offsets.size() * sizeof(pvs.offsets[0]));
+    out.write(reinterpret_cast<const char*>(pvs.bits.data()),
+              pvs.bits.size() * sizeof(pvs.bits[0]));
+    out.write(reinterpret_cast<const char*>(pvs.clusters.data()),
+              pvs.clusters.size() * sizeof(pvs.clusters[0]));
+    if (pvs.clusters.size() % 2) {
+        const std::uint32_t pad = 0;
+        out.write(reinterpret_cast<const char*>(&pad), sizeof(pad));
+    }
+    out.close();
+    if (!out) {
+        throw err::io_error() << err::file_name(path)
+                              << err::reason("could not write pvs file");
+    }
+}
+
+PotentiallyVisibleSet
+load_pvs(const std::string& path, const Maze& maze)
+{
+    std::ifstream in(path.c_str(), std::ios::binary);
+    if (!in) {
+        throw err::io_error() << err::file_name(path)
+                              << err::reason("could not open pvs file");
+    }
+    file::PvsHeader h;
+    if (!in.read(reinterpret_cast<char*>(&h), sizeof(h))) {
+        throw err::bad_format() << err::file_name(path)
+                                << err::reason("too short for a pvs file");
+    }
+    in.seekg(0, std::ios::end);
+    const std::uint64_t words = (std::uint64_t(in.tellg()) - sizeof(h)) / 8;
+    in.seekg(sizeof(h));
+
+    // the header may be anything, so the sizes are checked against the
+    // words left in the file before anything is allocated
+    const char* problem = nullptr;
+    const std::uint64_t cells = std::uint64_t(maze.getWidth()) *
+                                maze.getHeight();
+    if (!std::equal(file::PVS_MAGIC, file::PVS_MAGIC + 4, h.magic)) {
+        problem = "not a pvs file";
+    } else if (h.version != file::PVS_VERSION) {
+        problem = "unsupported pvs file version";
+    } else if (h.width != maze.getWidth() || h.height != maze.getHeight() ||
+               h.walls != hash_walls(maze.getGrid())) {
+        problem = "pvs file is for another maze";
+    } else if (cells >= words || h.entries > words - cells - 1 ||
+               h.entries + (h.entries + 1) / 2 > words - cells - 1) {
+        problem = "pvs file is truncated";
+    }
+    if (problem) {
+        throw err::bad_format() << err::file_name(path)
+                                << err::reason(problem);
+    }
+
+    PotentiallyVisibleSet pvs;
+    pvs.width      = h.width;
+    pvs.height     = h.height;
+    pvs.radius     = h.radius;
+    pvs.clusters_x = (h.width + C - 1) / C;
+    pvs.walls      = h.walls;
+    pvs.offsets.resize(h.width * h.height + 1);
+    pvs.bits.resize(h.entries);
+    pvs.clusters.resize(h.entries);
+    in.read(reinterpret_cast<char*>(pvs.offsets.data()),
+            pvs.offsets.size() * sizeof(pvs.offsets[0]));
+    in.read(reinterpret_cast<char*>(pvs.bits.data()),
+            pvs.bits.size() * sizeof(pvs.bits[0]));
+    in.read(reinterpret_cast<char*>(pvs.clusters.data()),
+            pvs.clusters.size() * sizeof(pvs.clusters[0]));
+    if (!in || pvs.offsets.front() != 0 || pvs.offsets.back() != h.entries ||
+        !std::is_sorted(pvs.offsets.begin(), pvs.offsets.end())) {
+        throw err::bad_format() << err::file_name(path)
+                                << err::reason("pvs file is truncated");
+    }
+    return pvs;
+}
+
+} // end namespace maps
@@ -0,0 +1,124 @@
+#ifndef PVS_HPP_GUARD
+#define PVS_HPP_GUARD
+/**
+ * @file pvs.hpp
+ * Precomputed potentially visible sets of the cells of a maze.
+ *
+ * File layout, version 2 - every field in the byte order of the machine that
+ * wrote it (a file from a machine of the other order fails the version
+ * check), sections 8 byte aligned:
+ * <pre>
+ * PvsHeader
+ * offsets:  width * height + 1 uint64, cell i's sets are entries
+ *           offsets[i] .. offsets[i+1]
+ * bits:     entries uint64 masks
+ * clusters: entries uint32 cluster ids, padded to 8 bytes
+ * </pre>
+ *
+ * @since 2026-10-17
+ */
+
+#include "maze.hpp"
+#include "exceptions.hpp"
+
+#include <cstdint>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace maps {
+
+namespace file {
+
+const char PVS_MAGIC[4] = {'H', 'X', 'P', 'V'};
+const std::uint32_t PVS_VERSION = 2;
+
+struct PvsHeader {
+    char magic[4];
+    std::uint32_t version;
+    std::uint64_t width;
+    std::uint64_t height;
+    std::uint64_t radius;
+    std::uint64_t entries;
+    /** hash of the walls of the maze the sets were built for */
+    std::uint64_t walls;
+};
+
+} // end namespace file
+
+class PotentiallyVisibleSet;
+
+/** Writes the sets to path, replacing the file. */
+void save_pvs(const PotentiallyVisibleSet& pvs, const std::string& path);
+
+/**
+ * Reads sets written by save_pvs() for maze.
+ *
+ * @throw err::bad_format if the file is damaged, or was built for a maze
+ *        of another size or with other walls
+ */
+PotentiallyVisibleSet load_pvs(const std::string& path, const Maze& maze);
+
+/**
+ * For every path cell, the cells its field of view (Visibility) reaches
+ * within a radius, so "could B be seen from A" is a lookup at run time -
+ * for culling what to render and what to tell a client about.
+ *
+ * The grid is cut into clusters of 8 x 8 cells and a cell's set is stored
+ * as the clusters it sees into, each with a 64 bit mask of the cells seen
+ * in it. Corridors see few clusters, so a set is typically a handful of
+ * entries; a lookup is a binary search over them and a bit test.
+ *
+ * Building runs one field of view per path cell, spread over threads, and
+ * is meant for load time or offline use with save_pvs().
+ */
+class PotentiallyVisibleSet {
+    public:
+    typedef std::pair<size_t, size_t> cell;
+
+    static const size_t CLUSTER_SIZE = 8;
+
+    private:
+    size_t width;
+    size_t height;
+    size_t radius;
+    size_t clusters_x;
+    /** hash of the walls the sets were built for */
+    std::uint64_t walls;
+    /** cell i's sets are entries offsets[i] .. offsets[i+1] */
+    std::vector<std::uint64_t> offsets;
+    std::vector<std::uint32_t> clusters; // sorted within a cell
+    std::vector<std::uint64_t> bits;
+
+    PotentiallyVisibleSet();
+
+    friend void save_pvs(const PotentiallyVisibleSet&, const std::string&);
+    friend PotentiallyVisibleSet load_pvs(const std::string&, const Maze&);
+
+    public:
+    /**
+     * @param radius how far a cell sees, in cells
+     * @param threads to build with, at least 1
+     */
+    PotentiallyVisibleSet(const Maze& maze, size_t radius = 16,
+                          unsigned int threads = 1);
+
+    /** Whether to is in the visible set of from. */
+    bool isVisible(cell from, cell to) const;
+
+    size_t getWidth()  const { return width; }
+    size_t getHeight() const { return height; }
+    size_t getRadius() const { return radius; }
+
+    /** Bytes used by the sets. */
+    size_t
+    memoryUsage() const {
+        return offsets.size() * sizeof(offsets[0]) +
+               clusters.size() * sizeof(clusters[0]) +
+               bits.size() * sizeof(bits[0]);
+    }
+};
+
+} // end namespace maps
+
+#endif
@@ -0,0 +1,69 @@
+#ifndef RANDOM_WALLS_HPP_GUARD
+#define RANDOM_WALLS_HPP_GUARD
+/**
+ * @file random_walls.hpp
+ * The serial wall generator, independent of how the cells are stored.
+ *
+ * @since 2026-10-17
+ */
+
+#include "../misc/utility.hpp"
+
+#include <cstddef>
+#include <utility>
+
+namespace maps {
+
+/**
+ * Makes the walls of a width x height maze with walls on its borders by
+ * random walks from random even cells: density walks of up to complexity
+ * steps of two cells, each step walling over a path cell and the cell it
+ * leaves behind. Does not allocate.
+ *
+ * @param is_path (x, y) -> bool
+ * @param set_wall (x, y) makes the cell an inner wall
+ */
+template <typename Generator, typename IsPath, typename SetWall>
+void
+random_walls(size_t width, size_t height, Generator& rng,
+             double density_factor, double complexity_factor,
+             IsPath is_path, SetWall set_wall)
+{
+    using std::make_pair;
+    using utility::rand;
+
+    size_t complexity = size_t(complexity_factor*(5*(width + height)));
+    size_t density    = size_t(density_factor*width/2*height/2);
+
+    for (size_t i = 0; i < density; ++i) {
+        size_t x = rand(rng, 0, width/2)*2;
+        size_t y = rand(rng, 0, height/2)*2;
+        set_wall(x, y);
+
+        std::pair<size_t, size_t> neigh[4];
+        for (size_t j = 0; j < complexity; ++j) {
+            size_t n_neigh = 0;
+            // add all neighbors that are not out of bounds
+            if (x > 1)        { neigh[n_neigh++] = make_pair(x-2, y); }
+            if (x < height-2) { neigh[n_neigh++] = make_pair(x+2, y); }
+            if (y > 1)        { neigh[n_neigh++] = make_pair(x, y-2); }
+            if (y < width-2)  { neigh[n_neigh++] = make_pair(x, y+2); }
+            if (n_neigh) { // choose a random neighbor if there are any
+                auto n = neigh[rand(rng, 0, n_neigh)];
+                if (is_path(n.first, n.second)) {
+                    auto link = make_pair(
+                            x + static_cast<long long>(n.first - x)/2,
+                            y + static_cast<long long>(n.second - y)/2);
+                    set_wall(n.first,    n.second);
+                    set_wall(link.first, link.second);
+                    x = n.first;
+                    y = n.second;
+                }
+            }
+        }
+    }
+}
+
+} // end namespace maps
+
+#endif
@@ -0,0 +1,65 @@
+#ifndef STAMPED_SET_HPP_GUARD
+#define STAMPED_SET_HPP_GUARD
+/**
+ * @file stamped_set.hpp
+ * A set of small integers that empties in constant time.
+ *
+ * @since 2026-10-17
+ */
+
+#include <algorithm>
+#include <cassert>
+#include <cstdint>
+#include <vector>
+
+namespace maps {
+
+/**
+ * A set of the integers 0 .. n-1, for the visited marks of searches that
+ * run many times over the same grid or graph.
+ *
+ * An element is in the set if its stamp equals the current generation, so
+ * emptying the set is an increment; the stamps are only cleared when the
+ * generation wraps around. Searches keep one per thread, next to their
+ * other per-element arrays, and reuse it for every query.
+ */
+class StampedSet {
+    std::vector<std::uint32_t> stamps;
+    std::uint32_t generation;
+
+    public:
+    StampedSet() : stamps(), generation(0) {}
+
+    /** Empties the set and makes it hold 0 .. n-1. */
+    void
+    clear(size_t n)
+    {
+        if (stamps.size() != n) {
+            stamps.assign(n, 0);
+            generation = 0;
+        }
+        if (++generation == 0) { // wrapped, the stamps are ambiguous now
+            std::fill(stamps.begin(), stamps.end(), 0);
+            generation = 1;
+        }
+    }
+
+    inline bool
+    contains(size_t i) const {
+        assert(i < stamps.size());
+        return stamps[i] == generation;
+    }
+
+    inline void
+    insert(size_t i) {
+        assert(i < stamps.size());
+        stamps[i] = generation;
+    }
+
+    /** The number of integers the set can hold, n of the last clear(). */
+    size_t capacity() const { return stamps.size(); }
+};
+
+} // end namespace maps
+
+#endif
@@ -0,0 +1,199 @@
+/**
+ * @file visibility.cpp
+ * Line of sight and field of view through the walls of a maze.
+ *
+ * @since 2026-10-17
+ */
+
+#include "visibility.hpp"
+#include "stamped_set.hpp"
+
+#include <algorithm>
+#include <cstdlib>
+
+namespace maps {
+
+namespace {
+typedef BitGrid::word_type word_type;
+
+/** whether any of the cells lo .. hi of row y is a wall */
+inline bool
+row_blocked(const BitGrid& grid, long lo, long hi, long y)
+{
+    const long B = BitGrid::WORD_BITS;
+    for (long x = lo; x <= hi; x += B) {
+        const long n = std::min(B, hi - x + 1);
+        const word_type mask = n == B ? ~word_type(0)
+                                      : (word_type(1) << n) - 1;
+        if (grid.wallWord(x, y) & mask) { return true; }
+    }
+    return false;
+}
+
+/** whether any of the cells lo .. hi of column x is a wall */
+inline bool
+column_blocked(const BitGrid& grid, long x, long lo, long hi)
+{
+    for (long y = lo; y <= hi; ++y) {
+        if (grid.wallWord(x, y) & 1) { return true; }
+    }
+    return false;
+}
+
+/**
+ * Step i of a digital line of run major steps and rise minor ones is on
+ * minor step round(i * rise / run), halves rounding up. This is the first
+ * step on minor step k.
+ */
+inline long
+first_step(long k, long run, long rise)
+{
+    if (k == 0) { return 0; }
+    if (k > rise) { return run + 1; }
+    const long a = (2 * k - 1) * run, b = 2 * rise;
+    return (a + b - 1) / b;
+}
+
+/** Field of view state of one thread: the cells seen so far. */
+thread_local StampedSet workspace;
+
+/** octant transforms: (dx, dy) in octant space -> (x, y) offsets */
+const int XX[8] = { 1,  0,  0, -1, -1,  0,  0,  1 };
+const int XY[8] = { 0,  1, -1,  0,  0, -1,  1,  0 };
+const int YX[8] = { 0,  1,  1,  0,  0, -1, -1,  0 };
+const int YY[8] = { 1,  0,  0,  1, -1,  0,  0, -1 };
+
+struct Caster {
+    const BitGrid& grid;
+    StampedSet& seen;
+    std::vector<Visibility::cell>& visible;
+    long cx, cy;
+    long radius;
+
+    void
+    see(long x, long y) {
+        if (x < 0 || y < 0 ||
+            size_t(x) >= grid.getWidth() || size_t(y) >= grid.getHeight()) {
+            return;
+        }
+        const size_t i = size_t(y) * grid.getWidth() + size_t(x);
+        if (!seen.contains(i)) {
+            seen.insert(i);
+            visible.push_back(Visibility::cell(x, y));
+        }
+    }
+
+    /**
+     * Scans the rows row .. radius of an octant between the slopes start
+     * and end, recursing past each wall to scan the light around it.
+     */
+    void
+    cast(long row, double start, double end, int o) {
+        if (start < end) { return; }
+        double new_start = 0;
+        for (long i = row; i <= radius; ++i) {
+            bool blocked = false;
+            for (long dx = -i, dy = -i; dx <= 0; ++dx) {
+                const long x = cx + dx * XX[o] + dy * XY[o];
+                const long y = cy + dx * YX[o] + dy * YY[o];
+                const double l_slope = (dx - 0.5) / (dy + 0.5);
+                const double r_slope = (dx + 0.5) / (dy - 0.5);
+                if (start < r_slope) { continue; }
+                if (end > l_slope) { break; }
+
+                if (dx * dx + dy * dy <= radius * radius) { see(x, y); }
+                const bool wall = grid.wallWord(x, y) & 1;
+                if (blocked) {
+                    if (wall) {
+                        new_start = r_slope;
+                    } else {
+                        blocked = false;
+                        start = new_start;
+                    }
+                } else if (wall && i < radius) {
+                    blocked = true;
+                    cast(i + 1, start, l_slope, o);
+                    new_start = r_slope;
+                }
+            }
+            if (blocked) { break; }
+        }
+    }
+};
+} // end anonymous namespace
+
+Visibility::Visibility(const Maze& maze)
+    : maze(maze)
+{}
+
+bool
+Visibility::canSee(cell from, cell to) const
+{
+    const BitGrid& grid = maze.get().getGrid();
+    if (to < from) { std::swap(from, to); } // the same line both ways
+    const long x0 = long(from.first), y0 = long(from.second);
+    const long x1 = long(to.first),   y1 = long(to.second);
+    const long adx = std::labs(x1 - x0), ady = std::labs(y1 - y0);
+    const long sx = x1 < x0 ? -1 : 1, sy = y1 < y0 ? -1 : 1;
+
+    if (adx >= ady) { // a run of cells per row
+        for (long k = 0; k <= ady; ++k) {
+            const long a = x0 + sx * first_step(k, adx, ady);
+            const long b = x0 + sx * (first_step(k + 1, adx, ady) - 1);
+            if (row_blocked(grid, std::min(a, b), std::max(a, b),
+                            y0 + sy * k)) {
+                return false;
+            }
+        }
+    } else { // a run of cells per column
+        for (long k = 0; k <= adx; ++k) {
+            const long a = y0 + sy * first_step(k, ady, adx);
+            const long b = y0 + sy * (first_step(k + 1, ady, adx) - 1);
+            if (column_blocked(grid, x0 + sx * k,
+                               std::min(a, b), std::max(a, b))) {
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+void
+Visibility::canSeeBatch(const Ray* rays, size_t n, std::uint64_t* mask) const
+{
+    for (size_t base = 0; base < n; base += 64) {
+        const size_t count = std::min<size_t>(64, n - base);
+        std::uint64_t bits = 0;
+        for (size_t i = 0; i < count; ++i) {
+            bits |= std::uint64_t(canSee(rays[base + i].from,
+                                         rays[base + i].to)) << i;
+        }
+        mask[base / 64] = bits;
+    }
+}
+
+void
+Visibility::fieldOfView(cell origin, size_t radius,
+                        std::vector<cell>& visible) const
+{
+    const BitGrid& grid = maze.get().getGrid();
+    StampedSet& seen = workspace;
+    seen.clear(grid.getWidth() * grid.getHeight());
+    visible.clear();
+
+    Caster caster = { grid, seen, visible,
+                      long(origin.first), long(origin.second), long(radius) };
+    caster.see(caster.cx, caster.cy);
+    for (int o = 0; o < 8; ++o) { caster.cast(1, 1.0, 0.0, o); }
+
+    // shadowcasting lets some rays past wall corners the digital line
+    // clips; keep only the path cells canSee() agrees with
+    visible.erase(std::remove_if(visible.begin(), visible.end(),
+                                 [&](const cell& c) {
+                                     return !grid.isWall(c.first, c.second) &&
+                                            !canSee(origin, c);
+                                 }),
+                  visible.end());
+}
+
+} // end namespace maps
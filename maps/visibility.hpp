@@ -0,0 +1,72 @@
+#ifndef VISIBILITY_HPP_GUARD
+#define VISIBILITY_HPP_GUARD
+/**
+ * @file visibility.hpp
+ * Line of sight and field of view through the walls of a maze.
+ *
+ * @since 2026-10-17
+ */
+
+#include "maze.hpp"
+
+#include <cstdint>
+#include <functional>
+#include <utility>
+#include <vector>
+
+namespace maps {
+
+/**
+ * Visibility between cells. A cell sees another if the digital line
+ * between their centers crosses no wall; cells outside the maze block.
+ * The line is always drawn from the smaller of the two cells (by x, then
+ * y), so sight is symmetric: a guard sees the player exactly when the
+ * player sees the guard.
+ *
+ * The line is walked as runs of cells sharing a row (or a column for steep
+ * lines). Each row run is tested against the packed wall row 64 cells per
+ * word, so long shallow rays cost a few word tests and stop at the first
+ * wall.
+ *
+ * The field of view uses recursive shadowcasting, then drops the path
+ * cells that canSee() says are hidden, which shadowcasting lets through
+ * past some wall corners. Its buffers are per thread and reused. All
+ * methods are safe to call from several threads.
+ */
+class Visibility {
+    public:
+    typedef std::pair<size_t, size_t> cell;
+
+    struct Ray {
+        cell from;
+        cell to;
+    };
+
+    private:
+    std::reference_wrapper<const Maze> maze;
+
+    public:
+    explicit Visibility(const Maze& maze);
+
+    /** Whether to can be seen from from. */
+    bool canSee(cell from, cell to) const;
+
+    /**
+     * canSee() for n rays. Bit i % 64 of mask[i / 64] is set if ray i is
+     * clear; mask needs room for (n + 63) / 64 words.
+     */
+    void canSeeBatch(const Ray* rays, size_t n, std::uint64_t* mask) const;
+
+    /**
+     * The cells visible from origin within radius (euclidean), origin
+     * included, walls that block the view included too.
+     *
+     * @param visible cleared, then filled; reuse it between calls
+     */
+    void fieldOfView(cell origin, size_t radius,
+                     std::vector<cell>& visible) const;
+};
+
+} // end namespace maps
+
+#endif
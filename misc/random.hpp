@@ -0,0 +1,173 @@
+#ifndef RANDOM_HPP_GUARD
+#define RANDOM_HPP_GUARD
+/**
+ * @file random.hpp
+ * Explicit, seedable random number generators.
+ *
+ * Every generator is a plain value - there is no hidden global state, so
+ * each thread (or each maze, or each song) owns its own and the same seed
+ * always yields the same sequence.
+ *
+ * @since 2026-10-17
+ */
+
+#include <cstdint>
+#include <limits>
+
+namespace utility {
+
+/**
+ * SplitMix64, used to expand a single 64 bit seed into generator state.
+ * Also handy as a hash when deriving seeds from coordinates.
+ */
+inline std::uint64_t
+splitmix64(std::uint64_t& state)
+{
+    std::uint64_t z = (state += 0x9e3779b97f4a7c15ULL);
+    z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+    z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+    return z ^ (z >> 31);
+}
+
+/**
+ * xoshiro256** by Blackman and Vigna.
+ *
+ * Satisfies UniformRandomBitGenerator, so it also works with <random>.
+ * jump() advances the generator by 2^128 steps, which splits one seed
+ * into up to 2^128 non-overlapping streams.
+ */
+class xoshiro256ss {
+    std::uint64_t s[4];
+
+    static inline std::uint64_t
+    rotl(std::uint64_t x, int k) { return (x << k) | (x >> (64 - k)); }
+
+    void
+    apply_jump(const std::uint64_t (&table)[4])
+    {
+        std::uint64_t t[4] = {0, 0, 0, 0};
+        for (auto j : table) {
+            for (int b = 0; b < 64; ++b) {
+                if (j & (std::uint64_t(1) << b)) {
+                    for (int i = 0; i < 4; ++i) { t[i] ^= s[i]; }
+                }
+                (*this)();
+            }
+        }
+        for (int i = 0; i < 4; ++i) { s[i] = t[i]; }
+    }
+
+    public:
+    typedef std::uint64_t result_type;
+
+    static const std::uint64_t DEFAULT_SEED = 0x4865786974ULL; // "Hexit"
+
+    explicit xoshiro256ss(std::uint64_t seed = DEFAULT_SEED)
+        : s()
+    {
+        this->seed(seed);
+    }
+
+    void
+    seed(std::uint64_t seed)
+    {
+        for (auto& w : s) { w = splitmix64(seed); }
+    }
+
+    static constexpr result_type min() { return 0; }
+    static constexpr result_type max()
+    {
+        return std::numeric_limits<result_type>::max();
+    }
+
+    inline result_type
+    operator()()
+    {
+        const std::uint64_t result = rotl(s[1] * 5, 7) * 9;
+        const std::uint64_t t = s[1] << 17;
+        s[2] ^= s[0];
+        s[3] ^= s[1];
+        s[1] ^= s[2];
+        s[0] ^= s[3];
+        s[2] ^= t;
+        s[3] = rotl(s[3], 45);
+        return result;
+    }
+
+    /**
+     * Uniform integer in [0, n), without modulo bias.
+     *
+     * Lemire's multiply-and-shift method - almost always a single
+     * multiplication, division only on the rare rejection path.
+     */
+    inline std::uint64_t
+    bounded(std::uint64_t n)
+    {
+        __extension__ typedef unsigned __int128 uint128;
+        if (n == 0) { return 0; }
+        uint128 m = uint128((*this)()) * n;
+        std::uint64_t low = std::uint64_t(m);
+        if (low < n) {
+            const std::uint64_t threshold = -n % n;
+            while (low < threshold) {
+                m = uint128((*this)()) * n;
+                low = std::uint64_t(m);
+            }
+        }
+        return std::uint64_t(m >> 64);
+    }
+
+    /** Uniform double in [0, 1). */
+    inline double
+    uniform()
+    {
+        return ((*this)() >> 11) * (1.0 / 9007199254740992.0);
+    }
+
+    /** Advances the generator by 2^128 calls. */
+    void
+    jump()
+    {
+        static const std::uint64_t table[4] = {
+            0x180ec6d33cfd0abaULL, 0xd5a61266f0c9392cULL,
+            0xa9582618e03fc9aaULL, 0x39abdc4529b1661cULL };
+        apply_jump(table);
+    }
+
+    /** Advances the generator by 2^192 calls. */
+    void
+    long_jump()
+    {
+        static const std::uint64_t table[4] = {
+            0x76e15d3efefdcbbfULL, 0xc5004e441c522fb3ULL,
+            0x77710069854ee241ULL, 0x39109bb02acbe635ULL };
+        apply_jump(table);
+    }
+
+    /**
+     * Returns a generator for an independent stream and moves this one past
+     * it. Calling split() n times gives n non-overlapping streams.
+     */
+    xoshiro256ss
+    split()
+    {
+        xoshiro256ss stream(*this);
+        jump();
+        return stream;
+    }
+
+    bool
+    operator==(const xoshiro256ss& o) const
+    {
+        return s[0] == o.s[0] && s[1] == o.s[1] &&
+               s[2] == o.s[2] && s[3] == o.s[3];
+    }
+    bool operator!=(const xoshiro256ss& o) const { return !(*this == o); }
+};
+
+/** The generator used throughout hexit. */
+typedef xoshiro256ss generator;
+
+}
+
+#endif
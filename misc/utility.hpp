@@ -8,33 +8,37 @@
  * @since 2012-05-01
  */
 
-#include <cstdlib> // for rand()
+#include "random.hpp"
+
+#include <cstddef>
+#include <utility>
 
 namespace utility {
 
-int rand(unsigned int start, unsigned int end)
+/** Uniform integer in [start, end) drawn from the generator g. */
+template <typename Generator>
+inline size_t rand(Generator& g, size_t start, size_t end)
 {
-    return std::rand()%(end-start)+start;
+    return g.bounded(end-start)+start;
 }
 
 
-template <typename RandomAccessContainer>
-auto random_pick(const RandomAccessContainer& c) -> decltype(c[0])
+template <typename Generator, typename RandomAccessContainer>
+auto random_pick(Generator& g, const RandomAccessContainer& c) -> decltype(c[0])
 {
-    return c[rand(0, c.size())];
+    return c[rand(g, 0, c.size())];
 }
 
 /** Knuth Shuffle */
-template <typename Array>
-void random_shuffle(Array& a)
+template <typename Generator, typename Array>
+void random_shuffle(Generator& g, Array& a)
 {
     /*tuki pride random shuffle*/
-    for (size_t i = a.size()-1; i > 1; i--) {
-        size_t j = rand(0, i);
-        // switch the ith and jth element
-        auto temp = a[j];
-        a[j] = a[i];
-        a[i] = temp;
+    for (size_t i = a.size(); i > 1; i--) {
+        size_t j = rand(g, 0, i);
+        // switch the last unshuffled and jth element
+        using std::swap;
+        swap(a[i-1], a[j]);
     }
 }
 
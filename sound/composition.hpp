@@ -121,7 +121,6 @@ notation::rhythm
 waltzbeat_bass(units::beat biti)
 {
     using namespace sgr::notation;
-    using utility::rand;
 
     rhythm bass;
     for (int i = 0; i < biti.value; ++i) {
@@ -138,7 +137,7 @@ waltzbeat_bass(units::beat biti)
 
 /// TODO write the damn thing
 notation::rhythm
-waltzbeat_mid(units::beat biti)
+waltzbeat_mid(units::beat biti, utility::generator& rng)
 {
     using namespace sgr::notation;
     using utility::rand;
@@ -155,7 +154,7 @@ waltzbeat_mid(units::beat biti)
     }
 
     for (int i = 0; i < 6; ++i) {
-        int a = rand(0, 101);
+        int a = rand(rng, 0, 101);
         if (a < 35) {
           for (int j = 0; j < (biti/3).value; ++j) {
               mid.push_back(
@@ -180,14 +179,14 @@ waltzbeat_high(units::beat biti)
 }
 
 std::vector<notation::rhythm>
-waltzbeat(units::beat beati)
+waltzbeat(units::beat beati, utility::generator& rng)
 {
     using namespace sgr::notation;
 
     std::vector<rhythm> rhythm;
 
     rhythm.push_back(waltzbeat_bass(beati));
-    rhythm.push_back(waltzbeat_mid(beati));
+    rhythm.push_back(waltzbeat_mid(beati, rng));
     rhythm.push_back(waltzbeat_high(beati));
     return rhythm;
 }
@@ -196,12 +195,14 @@ waltzbeat(units::beat beati)
  * Makes a melody out of a set of tones and a rhythm.
  * @param hits the sequence of notes to generate a melody to
  * @param tones the different tones we can use to generate a melody
+ * @param rng the source of randomness - the same seed gives the same melody
  * @return a sequence of notes.
  */
 std::vector<sgr::notation::note>
 make_melody(
         const notation::rhythm& hits,
-        const units::tones_type& tones
+        const units::tones_type& tones,
+        utility::generator& rng
         )
 {
     using namespace notation;
@@ -209,7 +210,7 @@ make_melody(
 
     std::vector<sgr::notation::note> notes;
     for (auto i : hits) {
-        auto tone = random_pick(tones);
+        auto tone = random_pick(rng, tones);
         notes.emplace_back(
                 instrument::sinewave::create(),
                 volume::fade::create(scalars::volume{0.8,0.8}, scalars::volume{0.4,0.4}),
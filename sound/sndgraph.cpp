@@ -90,7 +90,7 @@ void audio_callback(void *userdata, Uint8 *stream_in, int len_in) {
 
 
 
-int main( int /* argc */, char ** /* argv */ )
+int main( int argc, char ** argv )
 {
     using namespace sgr::notation;
     using units::scale_offset;
@@ -106,6 +106,11 @@ int main( int /* argc */, char ** /* argv */ )
 
     sgr::composition::resources stuff;
 
+    // the same seed always composes the same song
+    auto seed = (argc > 1) ? std::strtoull(argv[1], NULL, 0)
+                           : utility::generator::DEFAULT_SEED;
+    utility::generator rng(seed);
+
     auto lestvica = stuff.scales()["ionian"];
     auto trozvok  = stuff.chords()["trichord"];
     auto progression = stuff.progressions()["full circle"];
@@ -126,16 +131,16 @@ int main( int /* argc */, char ** /* argv */ )
             phrase << timing::constant::create(phrase_length, units::bps{4});
 
             auto bass_ritem = sgr::composition::waltzbeat_bass(phrase_length);
-            auto mid_ritem  = sgr::composition::waltzbeat_mid(phrase_length);
-            auto high_ritem = sgr::composition::waltzbeat_mid(phrase_length);
+            auto mid_ritem  = sgr::composition::waltzbeat_mid(phrase_length, rng);
+            auto high_ritem = sgr::composition::waltzbeat_mid(phrase_length, rng);
 
-            auto bass_note = sgr::composition::make_melody(bass_ritem, bass_toni[j]);
+            auto bass_note = sgr::composition::make_melody(bass_ritem, bass_toni[j], rng);
             phrase << bass_note;
 
-            auto mid_note = sgr::composition::make_melody(mid_ritem, mid_toni[j]);
+            auto mid_note = sgr::composition::make_melody(mid_ritem, mid_toni[j], rng);
             phrase << mid_note;
 
-            auto high_note = sgr::composition::make_melody(high_ritem, high_toni[j]);
+            auto high_note = sgr::composition::make_melody(high_ritem, high_toni[j], rng);
             phrase << high_note;
 
             song << phrase;